@@ -0,0 +1,296 @@
+#ifndef BASIC_GRAPH_H
+#define BASIC_GRAPH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../common/graph_kernels.hpp"
+
+// Storage backends
+struct AdjListStorage {};
+struct AdjMatrixStorage {};
+
+// Directedness tags
+struct Directed {};
+struct Undirected {};
+
+namespace detail {
+
+// Edge record of the list backend: just the target when unweighted
+template <typename WeightT, typename VertexId>
+struct ListEdge
+{
+    VertexId to;
+    WeightT weight;
+};
+
+template <typename WeightT, typename VertexId>
+struct ListEdgeOf
+{
+    using type = ListEdge<WeightT, VertexId>;
+};
+
+template <typename VertexId>
+struct ListEdgeOf<NoWeight, VertexId>
+{
+    using type = VertexId;
+};
+
+template <typename Storage, typename WeightT, typename VertexId>
+class StorageImpl;
+
+// Adjacency list: one vector of edge records per vertex
+template <typename WeightT, typename VertexId>
+class StorageImpl<AdjListStorage, WeightT, VertexId>
+{
+public:
+    using Edge = typename ListEdgeOf<WeightT, VertexId>::type;
+
+    explicit StorageImpl(VertexId n) : rows(n) {}
+
+    VertexId size() const { return static_cast<VertexId>(rows.size()); }
+
+    void addVertex() { rows.emplace_back(); }
+
+    // Parallel edges are kept, so every arc is a new one
+    bool addArc(VertexId u, VertexId v, WeightT w)
+    {
+        if constexpr (std::is_same_v<WeightT, NoWeight>) {
+            (void)w;
+            rows[u].push_back(v);
+        } else {
+            rows[u].push_back({v, w});
+        }
+        return true;
+    }
+
+    // Calls f(target, weight) for every out-edge of u
+    template <typename F>
+    void forEachNeighbor(VertexId u, F&& f) const
+    {
+        for (const Edge& e : rows[u]) {
+            if constexpr (std::is_same_v<WeightT, NoWeight>) {
+                f(e, NoWeight{});
+            } else {
+                f(e.to, e.weight);
+            }
+        }
+    }
+
+private:
+    std::vector<std::vector<Edge>> rows;
+};
+
+// Adjacency matrix: a flat presence bitmap plus, when weighted, a weight matrix
+template <typename WeightT, typename VertexId>
+class StorageImpl<AdjMatrixStorage, WeightT, VertexId>
+{
+public:
+    explicit StorageImpl(VertexId n) : n(n), present(std::size_t(n) * n, 0)
+    {
+        if constexpr (!std::is_same_v<WeightT, NoWeight>) {
+            weights.resize(std::size_t(n) * n);
+        }
+    }
+
+    VertexId size() const { return n; }
+
+    void addVertex()
+    {
+        VertexId m = n + 1;
+        std::vector<std::uint8_t> p(std::size_t(m) * m, 0);
+        for (VertexId i = 0; i < n; ++i) {
+            std::copy_n(present.begin() + std::size_t(i) * n, n, p.begin() + std::size_t(i) * m);
+        }
+        present.swap(p);
+        if constexpr (!std::is_same_v<WeightT, NoWeight>) {
+            std::vector<WeightT> w(std::size_t(m) * m);
+            for (VertexId i = 0; i < n; ++i) {
+                std::copy_n(weights.begin() + std::size_t(i) * n, n, w.begin() + std::size_t(i) * m);
+            }
+            weights.swap(w);
+        }
+        n = m;
+    }
+
+    // One arc per pair: a repeated arc keeps the lighter weight and returns false
+    bool addArc(VertexId u, VertexId v, WeightT w)
+    {
+        std::size_t idx = std::size_t(u) * n + v;
+        const bool added = !present[idx];
+        present[idx] = 1;
+        if constexpr (!std::is_same_v<WeightT, NoWeight>) {
+            if (added || w < weights[idx]) {
+                weights[idx] = w;
+            }
+        } else {
+            (void)w;
+        }
+        return added;
+    }
+
+    // Calls f(target, weight) for every out-edge of u
+    template <typename F>
+    void forEachNeighbor(VertexId u, F&& f) const
+    {
+        std::size_t row = std::size_t(u) * n;
+        for (VertexId v = 0; v < n; ++v) {
+            if (present[row + v]) {
+                if constexpr (std::is_same_v<WeightT, NoWeight>) {
+                    f(v, NoWeight{});
+                } else {
+                    f(v, weights[row + v]);
+                }
+            }
+        }
+    }
+
+private:
+    VertexId n;
+    std::vector<std::uint8_t> present;
+    std::vector<WeightT> weights;
+};
+
+} // namespace detail
+
+// Graph over a storage backend chosen at compile time.
+//
+// Storage is AdjListStorage or AdjMatrixStorage, WeightT is NoWeight (edges
+// carry no weight at all) or an arithmetic type, Directedness is Directed or
+// Undirected and VertexId is an unsigned 32 or 64-bit integer. The algorithms
+// are the common/graph_kernels.hpp ones that Vertex and the two Graph classes
+// also run.
+template <typename Storage, typename WeightT = NoWeight, typename Directedness = Undirected,
+          typename VertexId = std::uint32_t>
+class BasicGraph
+{
+    static_assert(std::is_same_v<Directedness, Directed> || std::is_same_v<Directedness, Undirected>,
+                  "Directedness must be Directed or Undirected");
+    static_assert(std::is_integral_v<VertexId> && std::is_unsigned_v<VertexId>,
+                  "VertexId must be an unsigned integer type");
+    static_assert(std::is_same_v<WeightT, NoWeight> || std::is_arithmetic_v<WeightT>,
+                  "WeightT must be NoWeight or an arithmetic type");
+
+public:
+    static constexpr bool isWeighted = !std::is_same_v<WeightT, NoWeight>;
+    static constexpr bool isDirected = std::is_same_v<Directedness, Directed>;
+    static constexpr VertexId npos = std::numeric_limits<VertexId>::max();
+
+    // Distance type used by Dijkstra
+    using Distance = std::conditional_t<std::is_floating_point_v<WeightT>, double, long long>;
+
+    // Constructor
+    explicit BasicGraph(VertexId n) : store(n), edges(0) {}
+
+    // Number of vertices
+    VertexId size() const { return store.size(); }
+
+    // Number of edges stored (an undirected edge counts once); the matrix
+    // backend holds one edge per pair, so repeating an edge there adds nothing
+    std::size_t edgeCount() const { return edges; }
+
+    // Adds a new vertex and returns its id
+    VertexId addVertex()
+    {
+        store.addVertex();
+        return size() - 1;
+    }
+
+    // Adds an unweighted edge
+    void addEdge(VertexId u, VertexId v)
+    {
+        static_assert(!isWeighted, "weighted graphs need addEdge(u, v, weight)");
+        insert(u, v, NoWeight{});
+    }
+
+    // Adds a weighted edge
+    template <typename W = WeightT>
+    void addEdge(VertexId u, VertexId v, W weight)
+    {
+        static_assert(isWeighted, "unweighted graphs take addEdge(u, v)");
+        insert(u, v, static_cast<WeightT>(weight));
+    }
+
+    // Calls f(target, weight) for every neighbor of u
+    template <typename F>
+    void forEachNeighbor(VertexId u, F&& f) const
+    {
+        store.forEachNeighbor(u, std::forward<F>(f));
+    }
+
+    // Breadth First Search order from start
+    std::vector<VertexId> BFS(VertexId start) const { return bfsOrder(*this, start); }
+
+    // Iterative Depth First Search order from start
+    std::vector<VertexId> DFS(VertexId start) const { return dfsOrder(*this, start); }
+
+    // Returns the fewest-hops path between u and v, empty if unreachable
+    std::vector<VertexId> getShortPath(VertexId u, VertexId v) const { return hopPath(*this, u, v); }
+
+    // Counts the number of vertices exactly 'level' hops from start
+    std::size_t getCountNthLevel(VertexId start, int level) const
+    {
+        if (level < 0) {
+            throw std::invalid_argument("Invalid level!!");
+        }
+        return countAtLevel(*this, start, level);
+    }
+
+    // Checks whether the graph contains a cycle; in an undirected graph a
+    // repeated edge between two vertices does not make one
+    bool isCycled() const
+    {
+        if constexpr (isDirected) {
+            return hasDirectedCycle(*this);
+        } else {
+            return hasUndirectedCycle(*this);
+        }
+    }
+
+    // Kahn's algorithm for topological sorting
+    std::vector<VertexId> Kahn() const
+    {
+        static_assert(isDirected, "topological order needs a directed graph");
+        std::vector<VertexId> res = kahnOrder(*this);
+        if (res.size() != size()) {
+            throw std::runtime_error("Graph is cycled!!");
+        }
+        return res;
+    }
+
+    // Tarjan's algorithm for strongly connected components, iterative
+    std::vector<std::vector<VertexId>> TarjansAlgorithm() const { return tarjanComponents(*this); }
+
+    // Dijkstra's single source shortest distances; unreachable vertices get max()
+    std::vector<Distance> Dijkstra(VertexId source) const
+    {
+        static_assert(isWeighted, "Dijkstra needs a weighted graph");
+        return dijkstraDistances<Distance>(*this, source);
+    }
+
+private:
+    detail::StorageImpl<Storage, WeightT, VertexId> store;
+    std::size_t edges;
+
+    void insert(VertexId u, VertexId v, WeightT w)
+    {
+        if (u >= size() || v >= size()) {
+            throw std::out_of_range("Invalid vertex!!");
+        }
+        const bool added = store.addArc(u, v, w);
+        if constexpr (!isDirected) {
+            if (u != v) {
+                store.addArc(v, u, w);
+            }
+        }
+        if (added) {
+            ++edges;
+        }
+    }
+};
+
+#endif
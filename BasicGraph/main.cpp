@@ -0,0 +1,56 @@
+#include <iostream>
+#include "basic_graph.hpp"
+
+template <typename T>
+void printVector(const std::vector<T>& vec)
+{
+    for (auto x : vec) {
+        std::cout << x << " ";
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    // Unweighted undirected adjacency list with 32-bit ids (same edges as the other demos)
+    BasicGraph<AdjListStorage> graph(5);
+    graph.addEdge(0, 1);
+    graph.addEdge(0, 4);
+    graph.addEdge(1, 2);
+    graph.addEdge(1, 3);
+    graph.addEdge(2, 3);
+    graph.addEdge(3, 4);
+
+    std::cout << "BFS (starting from vertex 0): ";
+    printVector(graph.BFS(0));
+    std::cout << "DFS (starting from vertex 0): ";
+    printVector(graph.DFS(0));
+    std::cout << "Shortest Path from 0 to 3: ";
+    printVector(graph.getShortPath(0, 3));
+    std::cout << "Vertices at level 2 from 0: " << graph.getCountNthLevel(0, 2) << std::endl;
+    std::cout << "Cycle Detected: " << (graph.isCycled() ? "Yes" : "No") << std::endl;
+
+    // Unweighted directed adjacency matrix with 64-bit ids
+    BasicGraph<AdjMatrixStorage, NoWeight, Directed, std::uint64_t> dag(4);
+    dag.addEdge(0, 1);
+    dag.addEdge(1, 2);
+    dag.addEdge(0, 3);
+    dag.addEdge(3, 2);
+    std::cout << "Topological Sort using Kahn's Algorithm: ";
+    printVector(dag.Kahn());
+    dag.addEdge(2, 0);
+    std::cout << "Strongly Connected Components (Tarjan's Algorithm):" << std::endl;
+    for (const auto& component : dag.TarjansAlgorithm()) {
+        printVector(component);
+    }
+
+    // Weighted undirected adjacency list; weights keep their double precision
+    BasicGraph<AdjListStorage, double> weighted(4);
+    weighted.addEdge(0, 1, 1.5);
+    weighted.addEdge(1, 2, 2.25);
+    weighted.addEdge(0, 2, 4.0);
+    weighted.addEdge(2, 3, 0.5);
+    std::cout << "Dijkstra from 0: ";
+    printVector(weighted.Dijkstra(0));
+
+    return 0;
+}
@@ -0,0 +1,378 @@
+#include "distributed.hpp"
+#include "graph.hpp"
+#include "../../common/transport.hpp"
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <stdexcept>
+
+// Contiguous ranges of about n / parts vertices each
+Partition Partition::blocks(int n, int parts)
+{
+    if (parts < 1) {
+        throw std::invalid_argument("Invalid part count!!");
+    }
+    Partition partition;
+    partition.bounds.resize(parts + 1);
+    for (int p = 0; p <= parts; ++p) {
+        partition.bounds[p] = static_cast<int>(static_cast<long long>(n) * p / parts);
+    }
+    return partition;
+}
+
+// Contiguous ranges carrying about the same number of out-edges plus vertices
+Partition Partition::edgeBalanced(const Vertex& graph, int parts)
+{
+    if (parts < 1) {
+        throw std::invalid_argument("Invalid part count!!");
+    }
+    const int n = graph.size();
+    std::vector<long long> prefix(n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        Vertex::Neighbors row = graph.neighbors(u);
+        prefix[u + 1] = prefix[u] + 1 + std::distance(row.begin(), row.end());
+    }
+    Partition partition;
+    partition.bounds.resize(parts + 1);
+    partition.bounds[0] = 0;
+    for (int p = 1; p <= parts; ++p) {
+        long long goal = prefix[n] * p / parts;
+        partition.bounds[p] = static_cast<int>(std::lower_bound(prefix.begin(), prefix.end(), goal) - prefix.begin());
+    }
+    partition.bounds[parts] = n;
+    return partition;
+}
+
+// Part owning vertex v
+int Partition::ownerOf(int v) const
+{
+    return static_cast<int>(std::upper_bound(bounds.begin(), bounds.end(), v) - bounds.begin()) - 1;
+}
+
+// Copies the out-edges and in-edges of the vertices 'rank' owns
+DistributedGraph::DistributedGraph(const Vertex& graph, const Partition& partition, int rank)
+    : partition {partition}
+    , rank {rank}
+{
+    if (partition.parts() < 1 || partition.bounds.front() != 0 || partition.bounds.back() != graph.size()) {
+        throw std::invalid_argument("Partition does not match the graph!!");
+    }
+    if (rank < 0 || rank >= partition.parts()) {
+        throw std::out_of_range("Invalid rank!!");
+    }
+    first = partition.begin(rank);
+    last = partition.end(rank);
+    offsets.push_back(0);
+    for (int u = first; u < last; ++u) {
+        for (int v : graph.neighbors(u)) {
+            targets.push_back(v);
+        }
+        outEnd.push_back(targets.size());
+        for (int v : graph.inNeighbors(u)) {
+            targets.push_back(v);
+        }
+        offsets.push_back(targets.size());
+    }
+}
+
+// Distributed BFS from 'start', gathered on rank 0
+std::vector<int> DistributedGraph::levels(Transport& transport, int start) const
+{
+    const int n = partition.bounds.back();
+    if (start < 0 || start >= n) {
+        throw std::out_of_range("Invalid vertex!!");
+    }
+    std::vector<int> dist(last - first, -1);
+    std::vector<int> frontier;
+    std::vector<int> next;
+    if (partition.ownerOf(start) == rank) {
+        dist[start - first] = 0;
+        frontier.push_back(start);
+    }
+
+    // A remote vertex is sent once: its owner settles its level on arrival
+    std::vector<unsigned char> sent(n, 0);
+    std::vector<std::vector<int>> outgoing(transport.size());
+    std::vector<std::vector<int>> incoming;
+    for (int level = 0;; ++level) {
+        for (auto& message : outgoing) {
+            message.clear();
+        }
+        next.clear();
+        for (int u : frontier) {
+            const std::size_t row = static_cast<std::size_t>(u - first);
+            for (std::size_t k = offsets[row]; k < outEnd[row]; ++k) {
+                int v = targets[k];
+                if (v >= first && v < last) {
+                    if (dist[v - first] < 0) {
+                        dist[v - first] = level + 1;
+                        next.push_back(v);
+                    }
+                } else if (!sent[v]) {
+                    sent[v] = 1;
+                    outgoing[partition.ownerOf(v)].push_back(v);
+                }
+            }
+        }
+        transport.exchange(outgoing, incoming);
+        for (int r = 0; r < transport.size(); ++r) {
+            if (r == rank) {
+                continue;
+            }
+            for (int v : incoming[r]) {
+                if (dist[v - first] < 0) {
+                    dist[v - first] = level + 1;
+                    next.push_back(v);
+                }
+            }
+        }
+        frontier.swap(next);
+        if (transport.allReduceSum(static_cast<long long>(frontier.size())) == 0) {
+            break;
+        }
+    }
+    return gather(transport, dist);
+}
+
+// Weakly connected components by min-label propagation, gathered on rank 0
+std::vector<int> DistributedGraph::componentLabels(Transport& transport) const
+{
+    const int n = partition.bounds.back();
+    std::vector<int> label(last - first);
+    std::vector<int> queue;
+    std::vector<unsigned char> queued(last - first, 1);
+    for (int u = first; u < last; ++u) {
+        label[u - first] = u;
+        queue.push_back(u);
+    }
+
+    // Smallest label already sent for every remote vertex
+    std::vector<int> sentLabel(n, INT_MAX);
+    std::vector<std::vector<int>> outgoing(transport.size());
+    std::vector<std::vector<int>> incoming;
+    auto lower = [&](int v, int value) {
+        if (value < label[v - first]) {
+            label[v - first] = value;
+            if (!queued[v - first]) {
+                queued[v - first] = 1;
+                queue.push_back(v);
+            }
+        }
+    };
+    for (;;) {
+        // Settle labels inside this part; boundary updates go out as (vertex, label)
+        for (auto& message : outgoing) {
+            message.clear();
+        }
+        while (!queue.empty()) {
+            int u = queue.back();
+            queue.pop_back();
+            queued[u - first] = 0;
+            const int value = label[u - first];
+            const std::size_t row = static_cast<std::size_t>(u - first);
+            for (std::size_t k = offsets[row]; k < offsets[row + 1]; ++k) {
+                int v = targets[k];
+                if (v >= first && v < last) {
+                    lower(v, value);
+                } else if (value < sentLabel[v]) {
+                    sentLabel[v] = value;
+                    std::vector<int>& message = outgoing[partition.ownerOf(v)];
+                    message.push_back(v);
+                    message.push_back(value);
+                }
+            }
+        }
+        transport.exchange(outgoing, incoming);
+        for (int r = 0; r < transport.size(); ++r) {
+            if (r == rank) {
+                continue;
+            }
+            for (std::size_t k = 0; k + 1 < incoming[r].size(); k += 2) {
+                lower(incoming[r][k], incoming[r][k + 1]);
+            }
+        }
+        if (transport.allReduceSum(static_cast<long long>(queue.size())) == 0) {
+            break;
+        }
+    }
+    return gather(transport, label);
+}
+
+// Collects the owned values of every rank into one vector on rank 0
+std::vector<int> DistributedGraph::gather(Transport& transport, const std::vector<int>& local) const
+{
+    std::vector<std::vector<int>> outgoing(transport.size());
+    outgoing[0] = local;
+    std::vector<std::vector<int>> incoming;
+    transport.exchange(outgoing, incoming);
+    if (rank != 0) {
+        return {};
+    }
+    std::vector<int> all;
+    all.reserve(partition.bounds.back());
+    for (int r = 0; r < transport.size(); ++r) {
+        all.insert(all.end(), incoming[r].begin(), incoming[r].end());
+    }
+    return all;
+}
+
+namespace {
+
+enum Job
+{
+    levelsJob,
+    componentsJob,
+};
+
+// Rank 0 tells every rank which job to run, and with what argument
+void sendJob(Transport& transport, Job job, int argument)
+{
+    std::vector<std::vector<int>> outgoing(transport.size(), std::vector<int> {job, argument});
+    std::vector<std::vector<int>> incoming;
+    transport.exchange(outgoing, incoming);
+}
+
+// One job on ranks 1..: the counterpart of a distributed*() call on rank 0
+void serveJob(Transport& transport)
+{
+    std::vector<std::vector<int>> outgoing(transport.size());
+    std::vector<std::vector<int>> incoming;
+    transport.exchange(outgoing, incoming);
+    const std::vector<int> job = incoming[0];
+    DistributedGraph local = DistributedGraph::receive(transport);
+    if (job[0] == levelsJob) {
+        local.levels(transport, job[1]);
+    } else {
+        local.componentLabels(transport);
+    }
+}
+
+// Rejects a bad call on rank 0 before the other ranks start, so they stay usable
+void checkRun(const DistributedProcesses& processes, const Vertex& graph, const Partition& partition)
+{
+    if (partition.parts() != processes.size()) {
+        throw std::invalid_argument("Partition does not match the processes!!");
+    }
+    if (partition.bounds.front() != 0 || partition.bounds.back() != graph.size()) {
+        throw std::invalid_argument("Partition does not match the graph!!");
+    }
+}
+
+}
+
+// Sends every rank its rows, one rank at a time so only one slice is encoded at once
+DistributedGraph DistributedGraph::scatter(Transport& transport, const Vertex& graph, const Partition& partition)
+{
+    if (partition.parts() != transport.size()) {
+        throw std::invalid_argument("Partition does not match the processes!!");
+    }
+    std::vector<std::vector<int>> outgoing(transport.size());
+    std::vector<std::vector<int>> incoming;
+    for (int r = 1; r < transport.size(); ++r) {
+        outgoing[r] = DistributedGraph(graph, partition, r).encode();
+        transport.exchange(outgoing, incoming);
+        std::vector<int>().swap(outgoing[r]);
+    }
+    return DistributedGraph(graph, partition, 0);
+}
+
+// The rows rank 0 sends this rank from scatter()
+DistributedGraph DistributedGraph::receive(Transport& transport)
+{
+    std::vector<std::vector<int>> outgoing(transport.size());
+    std::vector<std::vector<int>> incoming;
+    std::vector<int> message;
+    for (int r = 1; r < transport.size(); ++r) {
+        transport.exchange(outgoing, incoming);
+        if (r == transport.rank()) {
+            message.swap(incoming[0]);
+        }
+    }
+    return decode(message);
+}
+
+// The bounds, the rank, the out- and in-degree of every row, then the targets
+std::vector<int> DistributedGraph::encode() const
+{
+    std::vector<int> message;
+    message.reserve(partition.bounds.size() + 2 + 2 * static_cast<std::size_t>(last - first) + targets.size());
+    message.push_back(partition.parts());
+    message.insert(message.end(), partition.bounds.begin(), partition.bounds.end());
+    message.push_back(rank);
+    for (std::size_t row = 0; row + 1 < offsets.size(); ++row) {
+        message.push_back(static_cast<int>(outEnd[row] - offsets[row]));
+        message.push_back(static_cast<int>(offsets[row + 1] - outEnd[row]));
+    }
+    message.insert(message.end(), targets.begin(), targets.end());
+    return message;
+}
+
+DistributedGraph DistributedGraph::decode(const std::vector<int>& message)
+{
+    DistributedGraph local;
+    std::size_t at = 0;
+    auto take = [&](std::size_t count) {
+        if (message.size() - at < count) {
+            throw std::runtime_error("Corrupt rows message!!");
+        }
+        at += count;
+        return message.begin() + (at - count);
+    };
+    const int parts = *take(1);
+    if (parts < 1) {
+        throw std::runtime_error("Corrupt rows message!!");
+    }
+    auto bounds = take(parts + 1);
+    local.partition.bounds.assign(bounds, bounds + parts + 1);
+    local.rank = *take(1);
+    if (local.rank < 0 || local.rank >= parts) {
+        throw std::runtime_error("Corrupt rows message!!");
+    }
+    local.first = local.partition.begin(local.rank);
+    local.last = local.partition.end(local.rank);
+    auto degrees = take(2 * static_cast<std::size_t>(local.last - local.first));
+    local.offsets.push_back(0);
+    for (int u = local.first; u < local.last; ++u, degrees += 2) {
+        local.outEnd.push_back(local.offsets.back() + degrees[0]);
+        local.offsets.push_back(local.outEnd.back() + degrees[1]);
+    }
+    local.targets.assign(message.begin() + at, message.end());
+    if (local.targets.size() != local.offsets.back()) {
+        throw std::runtime_error("Corrupt rows message!!");
+    }
+    return local;
+}
+
+DistributedProcesses::DistributedProcesses(int processes)
+    : ProcessGroup(processes, serveJob)
+{
+}
+
+// Runs DistributedGraph::levels() on 'processes', one part per rank
+std::vector<int> distributedLevels(DistributedProcesses& processes, const Vertex& graph, int start,
+                                   const Partition& partition)
+{
+    checkRun(processes, graph, partition);
+    if (start < 0 || start >= graph.size()) {
+        throw std::out_of_range("Invalid vertex!!");
+    }
+    std::vector<int> result;
+    processes.run([&](Transport& transport) {
+        sendJob(transport, levelsJob, start);
+        result = DistributedGraph::scatter(transport, graph, partition).levels(transport, start);
+    });
+    return result;
+}
+
+// Runs DistributedGraph::componentLabels() on 'processes', one part per rank
+std::vector<int> distributedComponents(DistributedProcesses& processes, const Vertex& graph,
+                                       const Partition& partition)
+{
+    checkRun(processes, graph, partition);
+    std::vector<int> result;
+    processes.run([&](Transport& transport) {
+        sendJob(transport, componentsJob, 0);
+        result = DistributedGraph::scatter(transport, graph, partition).componentLabels(transport);
+    });
+    return result;
+}
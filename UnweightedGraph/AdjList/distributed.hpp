@@ -0,0 +1,93 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <cstddef>
+#include <vector>
+#include "../../common/transport.hpp"
+
+class Vertex;
+
+// 1D partition of the vertex ids: part p owns the vertices [bounds[p], bounds[p + 1])
+struct Partition
+{
+    std::vector<int> bounds;
+
+    // Contiguous ranges of about n / parts vertices each
+    static Partition blocks(int n, int parts);
+
+    // Contiguous ranges carrying about the same number of out-edges plus vertices,
+    // so parts holding high-degree vertices get fewer of them
+    static Partition edgeBalanced(const Vertex& graph, int parts);
+
+    int parts() const { return static_cast<int>(bounds.size()) - 1; }
+    int begin(int p) const { return bounds[p]; }
+    int end(int p) const { return bounds[p + 1]; }
+
+    // Part owning vertex v
+    int ownerOf(int v) const;
+};
+
+// The rows one rank owns, for level-synchronous algorithms that exchange
+// frontiers through a Transport. Vertices keep their global ids.
+class DistributedGraph
+{
+public:
+    // Copies the out-edges and in-edges of the vertices 'rank' owns
+    DistributedGraph(const Vertex& graph, const Partition& partition, int rank);
+
+    // Called on rank 0 while every other rank calls receive(): sends each rank
+    // its own rows, one rank at a time, and returns those of rank 0
+    static DistributedGraph scatter(Transport& transport, const Vertex& graph, const Partition& partition);
+
+    // The rows rank 0 sends this rank from scatter()
+    static DistributedGraph receive(Transport& transport);
+
+    // Distributed BFS from 'start': the level of every vertex (-1 when unreachable)
+    // on rank 0, an empty vector on the others. One exchange per level sends each
+    // frontier vertex to its owner once.
+    std::vector<int> levels(Transport& transport, int start) const;
+
+    // Weakly connected components by min-label propagation: every vertex is
+    // labelled with the smallest id in its component, on rank 0 only. Labels
+    // settle locally before each exchange, so rounds track the number of
+    // partition crossings rather than the diameter.
+    std::vector<int> componentLabels(Transport& transport) const;
+
+private:
+    DistributedGraph() = default;
+
+    Partition partition;
+    int rank;
+    int first;                          // owned vertices [first, last)
+    int last;
+    std::vector<std::size_t> offsets;   // owned rows, out-edges then in-edges
+    std::vector<int> targets;
+    std::vector<std::size_t> outEnd;    // end of the out-edges inside every row
+
+    // Collects the owned values of every rank into one vector on rank 0
+    std::vector<int> gather(Transport& transport, const std::vector<int>& local) const;
+
+    // The rows as one message: the bounds, the rank, the out- and in-degree of
+    // every row, then the targets
+    std::vector<int> encode() const;
+    static DistributedGraph decode(const std::vector<int>& message);
+};
+
+// One process per part for distributedLevels() and distributedComponents().
+// The ranks are forked when it is created, so create it at the start of
+// main(), before any thread is started; they then serve any number of calls.
+class DistributedProcesses : public ProcessGroup
+{
+public:
+    explicit DistributedProcesses(int processes);
+};
+
+// Runs DistributedGraph::levels() on 'processes', one part per rank
+std::vector<int> distributedLevels(DistributedProcesses& processes, const Vertex& graph, int start,
+                                   const Partition& partition);
+
+// Runs DistributedGraph::componentLabels() on 'processes', one part per rank
+std::vector<int> distributedComponents(DistributedProcesses& processes, const Vertex& graph,
+                                       const Partition& partition);
+
+#endif
@@ -0,0 +1,416 @@
+#include "external_graph.hpp"
+#include "graph.hpp"
+#include "../../common/pending_result.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const std::uint32_t fileMagic = 0x53435247;     // "GRCS"
+const std::uint32_t fileVersion = 1;
+
+// Fixed-size file header; the edge targets follow it, then the row offsets
+struct FileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t vertices;
+    std::uint64_t edges;
+    std::uint64_t offsetsAt;
+};
+
+void readAt(int fd, void* data, std::size_t bytes, std::uint64_t at, const std::string& path)
+{
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t got = ::pread(fd, p, bytes, static_cast<off_t>(at));
+        if (got <= 0) {
+            throw std::runtime_error("Cannot read " + path);
+        }
+        p += got;
+        bytes -= static_cast<std::size_t>(got);
+        at += static_cast<std::uint64_t>(got);
+    }
+}
+
+} // namespace
+
+ExternalCsrWriter::ExternalCsrWriter(const std::string& path, int n)
+    : path {path}
+    , os {path, std::ios::binary | std::ios::trunc}
+    , offsets(static_cast<std::size_t>(n) + 1, 0)
+    , current {0}
+    , finished {false}
+{
+    if (!os) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    FileHeader header {};
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+ExternalCsrWriter::~ExternalCsrWriter()
+{
+    if (!finished) {
+        try {
+            finish();
+        } catch (...) {
+        }
+    }
+}
+
+// Appends the edge u -> v; sources must not decrease
+void ExternalCsrWriter::addEdge(int u, int v)
+{
+    const int n = static_cast<int>(offsets.size()) - 1;
+    if (u < 0 || u >= n || v < 0 || v >= n) {
+        throw std::out_of_range("Invalid vertex!!");
+    }
+    if (finished || u < current) {
+        throw std::invalid_argument("Edges must be grouped by source!!");
+    }
+    const std::uint64_t count = offsets[current + 1];
+    while (current < u) {
+        offsets[++current + 1] = count;
+    }
+    os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    ++offsets[current + 1];
+}
+
+// Writes the offsets and the header
+void ExternalCsrWriter::finish()
+{
+    if (finished) {
+        return;
+    }
+    finished = true;
+    const int n = static_cast<int>(offsets.size()) - 1;
+    for (int v = current + 1; v < n; ++v) {
+        offsets[v + 1] = offsets[v];
+    }
+
+    FileHeader header {fileMagic, fileVersion, static_cast<std::uint64_t>(n), offsets[n], 0};
+    std::uint64_t end = sizeof(FileHeader) + offsets[n] * sizeof(int);
+    header.offsetsAt = (end + 7) / 8 * 8;
+    const char pad[8] = {};
+    os.write(pad, static_cast<std::streamsize>(header.offsetsAt - end));
+    os.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+    os.seekp(0);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.close();
+    if (!os) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+// Writes every live edge of 'graph' to 'path'
+void ExternalCsrWriter::write(const Vertex& graph, const std::string& path)
+{
+    ExternalCsrWriter writer(path, graph.size());
+    for (int u = 0; u < graph.size(); ++u) {
+        for (int v : graph.neighbors(u)) {
+            writer.addEdge(u, v);
+        }
+    }
+    writer.finish();
+}
+
+ExternalGraph::ExternalGraph(const std::string& path, std::size_t blockBytes)
+    : path {path}
+    , fd {::open(path.c_str(), O_RDONLY)}
+    , targetsAt {sizeof(FileHeader)}
+{
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    try {
+        FileHeader header {};
+        readAt(fd, &header, sizeof(header), 0, path);
+        if (header.magic != fileMagic) {
+            throw std::runtime_error("Not an edge file!!");
+        }
+        if (header.version != fileVersion) {
+            throw std::runtime_error("Unsupported edge file version!!");
+        }
+        if (header.vertices >= (std::uint64_t(1) << 31) || header.offsetsAt < targetsAt + header.edges * sizeof(int)) {
+            throw std::runtime_error("Corrupt edge file!!");
+        }
+        offsets.resize(header.vertices + 1);
+        readAt(fd, offsets.data(), offsets.size() * sizeof(std::uint64_t), header.offsetsAt, path);
+        if (offsets.front() != 0 || offsets.back() != header.edges || !std::is_sorted(offsets.begin(), offsets.end())) {
+            throw std::runtime_error("Corrupt edge file!!");
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Runs of whole rows of about blockBytes; a longer row gets a block of its own
+    const std::uint64_t perBlock = std::max<std::uint64_t>(1, blockBytes / sizeof(int));
+    const int n = size();
+    for (int first = 0; first < n;) {
+        int last = first + 1;
+        while (last < n && offsets[last + 1] - offsets[first] <= perBlock) {
+            ++last;
+        }
+        blocks.push_back({first, last});
+        blockFirst.push_back(first);
+        first = last;
+    }
+}
+
+ExternalGraph::~ExternalGraph()
+{
+    ::close(fd);
+}
+
+// Block holding the row of v
+std::size_t ExternalGraph::blockOf(int v) const
+{
+    return static_cast<std::size_t>(std::upper_bound(blockFirst.begin(), blockFirst.end(), v) - blockFirst.begin()) - 1;
+}
+
+// Reads the targets of block b into 'buffer' and returns it; checks them
+// here rather than on opening, which would read the whole file once more
+std::vector<int> ExternalGraph::readBlock(std::size_t b, std::vector<int> buffer) const
+{
+    const std::uint64_t begin = offsets[blocks[b].first];
+    const std::uint64_t end = offsets[blocks[b].last];
+    buffer.resize(end - begin);
+    readAt(fd, buffer.data(), buffer.size() * sizeof(int), targetsAt + begin * sizeof(int), path);
+    const int n = size();
+    if (std::any_of(buffer.begin(), buffer.end(), [n](int v) { return v < 0 || v >= n; })) {
+        throw std::runtime_error("Corrupt edge file!!");
+    }
+    return buffer;
+}
+
+// One pass over the wanted blocks, reading the next one while the current one is visited
+template <typename Want, typename Visit>
+void ExternalGraph::scan(Want want, Visit visit, ExternalStats& stats) const
+{
+    ++stats.passes;
+    auto nextWanted = [&](std::size_t b) {
+        while (b < blocks.size() && !want(b)) {
+            ++b;
+        }
+        return b;
+    };
+
+    PendingResult<std::vector<int>> ahead;
+    std::vector<int> spare;
+    auto queue = [&](std::size_t b) {
+        ahead.start([this, b, buffer = std::move(spare)]() mutable { return readBlock(b, std::move(buffer)); });
+    };
+
+    std::size_t b = nextWanted(0);
+    if (b < blocks.size()) {
+        queue(b);
+    }
+    while (b < blocks.size()) {
+        std::vector<int> current = ahead.take();
+        std::size_t next = nextWanted(b + 1);
+        if (next < blocks.size()) {
+            queue(next);
+        }
+        ++stats.blocksRead;
+        stats.bytesRead += current.size() * sizeof(int);
+
+        const Block& block = blocks[b];
+        for (int u = block.first; u < block.last; ++u) {
+            visit(u, current.data() + (offsets[u] - offsets[block.first]), static_cast<std::size_t>(offsets[u + 1] - offsets[u]));
+        }
+        spare = std::move(current);
+        b = next;
+    }
+}
+
+// BFS level of every vertex from 'start', -1 when unreachable
+std::vector<int> ExternalGraph::levels(int start, ExternalStats* stats) const
+{
+    const int n = size();
+    if (start < 0 || start >= n) {
+        throw std::out_of_range("Invalid vertex!!");
+    }
+    ExternalStats io;
+    std::vector<int> dist(n, -1);
+    std::vector<unsigned char> active(n, 0);
+    std::vector<std::size_t> activeIn(blocks.size(), 0);
+    std::size_t pending = 0;
+    auto activate = [&](int v) {
+        if (!active[v]) {
+            active[v] = 1;
+            ++activeIn[blockOf(v)];
+            ++pending;
+        }
+    };
+
+    dist[start] = 0;
+    activate(start);
+    while (pending > 0) {
+        scan([&](std::size_t b) { return activeIn[b] > 0; }, [&](int u, const int* targets, std::size_t count) {
+            if (!active[u]) {
+                return;
+            }
+            active[u] = 0;
+            --activeIn[blockOf(u)];
+            --pending;
+            for (std::size_t k = 0; k < count; ++k) {
+                int v = targets[k];
+                if (dist[v] < 0 || dist[u] + 1 < dist[v]) {
+                    dist[v] = dist[u] + 1;
+                    activate(v);
+                }
+            }
+        }, io);
+    }
+    if (stats) {
+        *stats = io;
+    }
+    return dist;
+}
+
+// Strongly connected component of every vertex, named by its smallest vertex id
+std::vector<int> ExternalGraph::componentIds(ExternalStats* stats) const
+{
+    const int n = size();
+    ExternalStats io;
+    std::vector<int> component(n, -1);
+    std::vector<std::size_t> liveIn(blocks.size());
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        liveIn[b] = static_cast<std::size_t>(blocks[b].last - blocks[b].first);
+    }
+    std::size_t remaining = static_cast<std::size_t>(n);
+    auto assign = [&](int v, int id) {
+        component[v] = id;
+        --liveIn[blockOf(v)];
+        --remaining;
+    };
+    auto hasLive = [&](std::size_t b) { return liveIn[b] > 0; };
+
+    // Upper bound on the live in-edges of every vertex from other vertices,
+    // recounted by every trimming pass; valid once 'counted' is set
+    std::vector<int> inDegree(n, 0);
+    std::vector<int> recount(n, 0);
+    bool counted = false;
+    std::vector<int> color(n);
+    std::vector<unsigned char> flag(n);
+    std::vector<std::size_t> flaggedIn(blocks.size());
+
+    while (remaining > 0) {
+        // Trimming: a live vertex with no live in-edges or no live out-edges is a
+        // component by itself. Passes continue while they remove a fair share.
+        for (;;) {
+            const std::size_t before = remaining;
+            std::fill(recount.begin(), recount.end(), 0);
+            scan(hasLive, [&](int u, const int* targets, std::size_t count) {
+                if (component[u] >= 0) {
+                    return;
+                }
+                bool hasOut = false;
+                for (std::size_t k = 0; k < count && !hasOut; ++k) {
+                    hasOut = targets[k] != u && component[targets[k]] < 0;
+                }
+                const bool trim = !hasOut || (counted && inDegree[u] == 0);
+                if (trim) {
+                    assign(u, u);
+                }
+                for (std::size_t k = 0; k < count; ++k) {
+                    int v = targets[k];
+                    if (v != u && component[v] < 0) {
+                        if (trim) {
+                            --inDegree[v];
+                        } else {
+                            ++recount[v];
+                        }
+                    }
+                }
+            }, io);
+            inDegree.swap(recount);
+            const bool firstCount = !counted;
+            counted = true;
+            if (remaining == 0 || (!firstCount && (before - remaining) * 16 < before)) {
+                break;
+            }
+        }
+        if (remaining == 0) {
+            break;
+        }
+
+        // Coloring: every live vertex takes the smallest id that reaches it.
+        // Only rows whose color dropped since they were last read are read again.
+        std::size_t active = 0;
+        std::fill(flaggedIn.begin(), flaggedIn.end(), 0);
+        for (int v = 0; v < n; ++v) {
+            color[v] = v;
+            flag[v] = component[v] < 0;
+            if (flag[v]) {
+                ++flaggedIn[blockOf(v)];
+                ++active;
+            }
+        }
+        while (active > 0) {
+            scan([&](std::size_t b) { return flaggedIn[b] > 0; }, [&](int u, const int* targets, std::size_t count) {
+                if (!flag[u]) {
+                    return;
+                }
+                flag[u] = 0;
+                --flaggedIn[blockOf(u)];
+                --active;
+                for (std::size_t k = 0; k < count; ++k) {
+                    int v = targets[k];
+                    if (component[v] < 0 && color[u] < color[v]) {
+                        color[v] = color[u];
+                        if (!flag[v]) {
+                            flag[v] = 1;
+                            ++flaggedIn[blockOf(v)];
+                            ++active;
+                        }
+                    }
+                }
+            }, io);
+        }
+
+        // Every vertex that kept its own id is the root of its color; the
+        // vertices of that color reaching it back form its component
+        std::size_t waiting = 0;
+        std::fill(flaggedIn.begin(), flaggedIn.end(), 0);
+        for (int v = 0; v < n; ++v) {
+            flag[v] = component[v] < 0 && color[v] == v;
+            if (component[v] < 0 && !flag[v]) {
+                ++flaggedIn[blockOf(v)];
+                ++waiting;
+            }
+        }
+        for (bool changed = waiting > 0; changed;) {
+            changed = false;
+            scan([&](std::size_t b) { return flaggedIn[b] > 0; }, [&](int u, const int* targets, std::size_t count) {
+                if (component[u] >= 0 || flag[u]) {
+                    return;
+                }
+                for (std::size_t k = 0; k < count; ++k) {
+                    int v = targets[k];
+                    if (flag[v] && component[v] < 0 && color[v] == color[u]) {
+                        flag[u] = 1;
+                        --flaggedIn[blockOf(u)];
+                        changed = true;
+                        return;
+                    }
+                }
+            }, io);
+        }
+        for (int v = 0; v < n; ++v) {
+            if (component[v] < 0 && flag[v]) {
+                assign(v, color[v]);
+            }
+        }
+    }
+    if (stats) {
+        *stats = io;
+    }
+    return component;
+}
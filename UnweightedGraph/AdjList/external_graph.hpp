@@ -0,0 +1,105 @@
+#ifndef EXTERNAL_GRAPH_H
+#define EXTERNAL_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Vertex;
+
+// I/O done by one algorithm run over an edge file
+struct ExternalStats
+{
+    int passes = 0;                 // scans over the block list; a scan reads only the blocks it needs
+    std::uint64_t blocksRead = 0;
+    std::uint64_t bytesRead = 0;
+};
+
+// Streams a directed graph into the on-disk CSR format read by ExternalGraph.
+// Only the row offsets are kept in RAM, so edges must arrive grouped by source.
+class ExternalCsrWriter
+{
+public:
+    ExternalCsrWriter(const std::string& path, int n);
+    ~ExternalCsrWriter();
+    ExternalCsrWriter(const ExternalCsrWriter&) = delete;
+    ExternalCsrWriter& operator=(const ExternalCsrWriter&) = delete;
+
+    // Appends the edge u -> v; sources must not decrease
+    void addEdge(int u, int v);
+
+    // Writes the offsets and the header; the file is incomplete until then
+    void finish();
+
+    // Writes every live edge of 'graph' to 'path'
+    static void write(const Vertex& graph, const std::string& path);
+
+private:
+    std::string path;
+    std::ofstream os;
+    std::vector<std::uint64_t> offsets;
+    int current;
+    bool finished;
+};
+
+// Semi-external graph: per-vertex state lives in RAM while the adjacency is
+// read from a CSR file in large sequential blocks. Every block is a run of
+// whole rows of about 'blockBytes'; the next wanted block is read on a
+// worker thread while the current one is processed.
+class ExternalGraph
+{
+public:
+    // Opens an edge file; a bad header or bad row offsets throw std::runtime_error
+    // here, an edge target outside the graph when the algorithm reads its block
+    explicit ExternalGraph(const std::string& path, std::size_t blockBytes = std::size_t(8) << 20);
+    ~ExternalGraph();
+    ExternalGraph(const ExternalGraph&) = delete;
+    ExternalGraph& operator=(const ExternalGraph&) = delete;
+
+    // Number of vertices
+    int size() const { return static_cast<int>(offsets.size()) - 1; }
+
+    // Number of edges in the file
+    std::uint64_t edgeCount() const { return offsets.back(); }
+
+    // BFS level of every vertex from 'start', -1 when unreachable. Label-correcting
+    // sweeps relax every row whose level changed since it was last read, so a
+    // sweep skips the blocks holding no such row and short chains settle in one sweep.
+    std::vector<int> levels(int start, ExternalStats* stats = nullptr) const;
+
+    // Strongly connected component of every vertex, named by its smallest vertex id.
+    // Alternates trimming of vertices without live in- or out-edges with coloring
+    // rounds: minimum ids are pushed forward until stable, then every vertex whose
+    // id survived marks its component by backward reachability within its color.
+    std::vector<int> componentIds(ExternalStats* stats = nullptr) const;
+
+private:
+    struct Block
+    {
+        int first;                  // vertices [first, last)
+        int last;
+    };
+
+    std::string path;
+    int fd;
+    std::uint64_t targetsAt;        // byte position of the edge targets
+    std::vector<std::uint64_t> offsets;
+    std::vector<Block> blocks;
+    std::vector<int> blockFirst;    // first vertex of every block, for lookups
+
+    // Block holding the row of v
+    std::size_t blockOf(int v) const;
+
+    // Reads the targets of block b into 'buffer' and returns it; throws
+    // std::runtime_error on a target outside the graph
+    std::vector<int> readBlock(std::size_t b, std::vector<int> buffer) const;
+
+    // One pass: calls visit(u, targets, count) for every row of every block
+    // for which want(b) holds, checked when the block is queued for reading
+    template <typename Want, typename Visit>
+    void scan(Want want, Visit visit, ExternalStats& stats) const;
+};
+
+#endif
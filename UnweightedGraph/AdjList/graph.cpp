@@ -1,207 +1,417 @@
 #include <iostream>
 #include "graph.hpp"
+#include "../../common/checkpoint.hpp"
+#include "../../common/graph_kernels.hpp"
+#include "../../common/instrument.hpp"
+#include "../../common/memory_policy.hpp"
+#include <algorithm>
+#include <iterator>
 #include <stack>
 #include <queue>
 
 // Constructor
-Vertex::Vertex(int n) 
+Vertex::Vertex(int n, std::pmr::memory_resource* resource) 
     : sizeVertexs {n}
-    , adjList {}
+    , adjList {resource}
+    , mutationVersion {0}
+    , edgeVersion {0}
+    , transposed {false}
+    , removed (n, 0)
+    , storedSlots {0}
+    , deadSlots {0}
+    , liveSlotsInto (n, 0)
+    , compactionRatio {0.25}
+    , backgroundCompaction {false}
 {
     adjList.resize(sizeVertexs);
 }
 
+// Waits for a background compaction, which still reads the rows
+Vertex::~Vertex()
+{
+    pendingCompaction.wait();
+}
+
 // Adds an edge between two vertices
 void Vertex::addEdge(int u, int v)
 {
+    if (removed[u] || removed[v]) {
+        throw std::invalid_argument("Vertex is removed!!");
+    }
+    beginChange();
     adjList[u].push_back(v);
     adjList[v].push_back(u); //  undirected
+    storedSlots += 2;
+    ++liveSlotsInto[u];
+    ++liveSlotsInto[v];
+    ++mutationVersion;
+    ++edgeVersion;
+}
+
+// Adds a directed edge from u to v
+void Vertex::addDirectedEdge(int u, int v)
+{
+    if (removed[u] || removed[v]) {
+        throw std::invalid_argument("Vertex is removed!!");
+    }
+    beginChange();
+    adjList[u].push_back(v);
+    ++storedSlots;
+    ++liveSlotsInto[v];
+    ++mutationVersion;
+    ++edgeVersion;
 }
 
 // Adds a new vertex
 void Vertex::addVertex() 
 {
+    beginChange();
     ++sizeVertexs;
     adjList.resize(sizeVertexs);
+    removed.push_back(0);
+    liveSlotsInto.push_back(0);
+    ++mutationVersion;
+    ++edgeVersion;
 }
 
-// Depth First Search (DFS) iterative method
-void Vertex::DFS(int start) const
+// Removes one edge between u and v; finding its slots scans both rows, O(deg u + deg v)
+bool Vertex::removeEdge(int u, int v)
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    std::stack<int>  st;
-    st.push(start);
-    visit[start] = true;
-    while (!st.empty()) {
-        int x = st.top();
-        std::cout << x <<  " ";
-        st.pop();
-        for(int i = 0; i < adjList[x].size(); ++i) {
-            if (!visit[adjList[x][i]]) {
-                st.push(adjList[x][i]);
-                visit[adjList[x][i]] = true;
+    beginChange();
+    if (!tombstone(u, v)) {
+        return false;
+    }
+    tombstone(v, u);
+    afterRemoval();
+    return true;
+}
+
+// Removes one directed edge from u to v; finding its slot scans the row of u, O(deg u)
+bool Vertex::removeDirectedEdge(int u, int v)
+{
+    beginChange();
+    if (!tombstone(u, v)) {
+        return false;
+    }
+    afterRemoval();
+    return true;
+}
+
+// Removes vertex v in O(out-degree of v): its row and the edges into it become tombstones,
+// and only its own row is walked to keep the live slot counts
+void Vertex::removeVertex(int v)
+{
+    beginChange();
+    if (removed[v]) {
+        return;
+    }
+    removed[v] = 1;
+    // Only slots that were still live die: v's out-edges to live vertices and
+    // every live edge into v, a self-loop among them
+    for (int x : adjList[v]) {
+        if (x >= 0 && x != v && !removed[x]) {
+            ++deadSlots;
+            --liveSlotsInto[x];
+        }
+    }
+    deadSlots += liveSlotsInto[v];
+    liveSlotsInto[v] = 0;
+    afterRemoval();
+}
+
+// Checks whether vertex v has been removed
+bool Vertex::isRemoved(int v) const
+{
+    return removed[v] != 0;
+}
+
+// Rewrites the rows without tombstones and frees the rows of removed vertices
+void Vertex::compact()
+{
+    finishCompaction();
+    installRows(compactedRows());
+}
+
+// Starts compact() on a worker thread
+void Vertex::compactInBackground()
+{
+    finishCompaction();
+    pendingCompaction.start([this] { return compactedRows(); });
+}
+
+// Installs a finished background compaction, waiting for it if needed
+void Vertex::finishCompaction()
+{
+    if (pendingCompaction.running()) {
+        installRows(pendingCompaction.take());
+    }
+}
+
+// Sets when removals trigger a compaction
+void Vertex::setCompactionThreshold(double ratio, bool background)
+{
+    compactionRatio = ratio;
+    backgroundCompaction = background;
+}
+
+// Settles pending work before the stored rows are modified
+void Vertex::beginChange()
+{
+    finishCompaction();
+    materialize();
+}
+
+// Marks the first stored slot u -> v as deleted, scanning the row of u
+bool Vertex::tombstone(int u, int v)
+{
+    if (removed[u] || removed[v]) {
+        return false;
+    }
+    for (int& x : adjList[u]) {
+        if (x == v) {
+            x = -1;
+            ++deadSlots;
+            --liveSlotsInto[v];
+            return true;
+        }
+    }
+    return false;
+}
+
+// Publishes a removal and compacts once tombstones pass the threshold
+void Vertex::afterRemoval()
+{
+    ++mutationVersion;
+    ++edgeVersion;
+    if (deadSlots > compactionRatio * storedSlots) {
+        if (backgroundCompaction) {
+            compactInBackground();
+        } else {
+            compact();
+        }
+    }
+}
+
+// Live copy of the stored rows; reads only, so it may run beside const queries
+std::pmr::vector<Vertex::AdjRow> Vertex::compactedRows() const
+{
+    std::pmr::vector<AdjRow> rows (sizeVertexs, adjList.get_allocator());
+    for (int u = 0; u < sizeVertexs; ++u) {
+        Neighbors live = stored(u);
+        rows[u].assign(live.begin(), live.end());
+    }
+    return rows;
+}
+
+// Replaces the stored rows with compacted ones holding the same edges
+void Vertex::installRows(std::pmr::vector<AdjRow> rows)
+{
+    adjList.swap(rows);
+    frozen.reset();
+    countSlots();
+}
+
+// Recounts the stored, dead and live incoming slots of adjList
+void Vertex::countSlots()
+{
+    storedSlots = 0;
+    deadSlots = 0;
+    liveSlotsInto.assign(sizeVertexs, 0);
+    for (int u = 0; u < sizeVertexs; ++u) {
+        for (int x : adjList[u]) {
+            ++storedSlots;
+            if (x < 0 || removed[u] || removed[x]) {
+                ++deadSlots;
+            } else {
+                ++liveSlotsInto[x];
             }
         }
     }
-    std::cout << std::endl;
 }
 
-// Depth First Search (DFS) recursive method
-void Vertex::DFS_REC(int start) const
+// Returns the number of vertices
+int Vertex::size() const
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    dfsHelper(start, visit);
+    return sizeVertexs;
+}
+
+// Returns the adjacency list of vertex u
+Vertex::Neighbors Vertex::neighbors(int u) const
+{
+    return out(u);
+}
+
+// Returns the vertices with an edge into u
+Vertex::Neighbors Vertex::inNeighbors(int u) const
+{
+    if (transposed) {
+        return stored(u);
+    }
+    return reverseIndex() -> row(u);
+}
+
+// Returns the mutation version, bumped by every structural change
+std::uint64_t Vertex::version() const
+{
+    return mutationVersion;
+}
+
+// out(u) as a graph for the common/graph_kernels.hpp algorithms
+auto Vertex::outGraph() const
+{
+    return neighborGraph(
+        sizeVertexs,
+        [this](int u, auto&& f) {
+            for (int v : out(u)) {
+                f(v, NoWeight {});
+            }
+        },
+        [this](int u) { return removed[u] != 0; });
+}
+
+// Depth First Search (DFS) iterative method
+void Vertex::DFS(int start) const
+{
+    GRAPH_SCOPE("Vertex::DFS");
+    for (int x : dfsOrder(outGraph(), start)) {
+        std::cout << x << " ";
+    }
     std::cout << std::endl;
 }
 
-// DFS helper function
-void Vertex::dfsHelper(int start, std::vector<bool>& visit) const
+// Depth First Search (DFS) recursive method
+void Vertex::DFS_REC(int start) const
 {
-    visit[start] = true;
-    std::cout << start << " ";
-    for(int i = 0; i < adjList[start].size(); ++i) {
-        int tmp = adjList[start][i];
-        if (!visit[tmp]) {
-            dfsHelper(tmp, visit);
-        }
+    GRAPH_SCOPE("Vertex::DFS_REC");
+    for (int x : preorder(outGraph(), start)) {
+        std::cout << x << " ";
     }
+    std::cout << std::endl;
 }
 
 // Breadth First Search (BFS)
 void Vertex::BFS(int start) const
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    std::queue<int> q;
-    q.push(start);
-    visit[start] = true;
-    while (!q.empty()) {
-        int x = q.front();
+    GRAPH_SCOPE("Vertex::BFS");
+    for (int x : bfsOrder(outGraph(), start)) {
         std::cout << x << " ";
-        q.pop();
-        for (int i = 0; i < adjList[x].size(); ++i) {
-            int tmp = adjList[x][i];
-            if (!visit[tmp]) {
-                visit[tmp] = true;
-                q.push(tmp);
-            }
-        }
-    } 
+    }
     std::cout << std::endl;
 }
 
 // Returns the shortest path between vertices u and v
 std::vector<int> Vertex::getShortPath(int u, int v)
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    std::queue<int> q;
-    std::vector<int> perent (sizeVertexs, -1);
-    q.push(u);
-    visit[u] = true;
-    while(!q.empty()) {
-        int n = q.front();
-        q.pop();
-        if (n == v) {
-            std::vector<int> path;
-            for(int i = v; i != -1; i = perent[i]) {
-                path.push_back(i);
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
-        for(int elem : adjList[n]) {
-            if (!visit[elem]) {
-                visit[elem] = true;
-                perent[elem] = n;
-                q.push(elem);
-            }
-        }
-    }
-    return {};
+    GRAPH_SCOPE("Vertex::getShortPath");
+    return hopPath(outGraph(), u, v);
 }
 
-// Transposes the graph (reverse all edges)
+// Transposes the graph (reverse all edges).
+// Only flips which side is read as out-edges; the in-edge index is built on
+// the first flip after a change and reused by every later flip.
 void Vertex::Transpose()
 {
-    Vertex tmp(sizeVertexs);
-    for(int i = 0; i < sizeVertexs; ++i) {
-        for(int j : adjList[i]) {
-            tmp.adjList[j].push_back(i);
-        }
+    if (transposed) {
+        flipped.reset();
+    } else {
+        flipped = reverseIndex();
     }
-    this -> adjList = tmp.adjList;
+    transposed = !transposed;
+    ++mutationVersion;
 }
 
-// Checks if the undirected graph contains a cycle
-bool Vertex::isCycledUndirected() const
+// Out-edges of u in the current orientation
+Vertex::Neighbors Vertex::out(int u) const
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    int parent = -1;
-    for (int i = 0; i < sizeVertexs; ++i) {
-        if (!visit[i]) {
-            if (dfsCycledUndirected(i, visit, parent)) {
-                return true;
-            }
-        }
+    if (transposed) {
+        return flipped -> row(u);
     }
-    return false;
+    return stored(u);
 }
 
-// Helper function for detecting a cycle in an undirected graph
-bool Vertex::dfsCycledUndirected(int start, std::vector<bool>& visit, int perent) const
+// Live entries of the stored row of u
+Vertex::Neighbors Vertex::stored(int u) const
 {
-    visit[start] = true;
-    for(auto u : adjList[start]) {
-        if (!visit[u]) {
-            if (dfsCycledUndirected(u, visit, start)) {
-                return true;
-            } 
-        } else if (u != perent) {
-            return true;
-        }
+    if (removed[u]) {
+        return {};
     }
-    return false;
+    if (frozen) {
+        const int* entries = frozen -> entries.data();
+        return Neighbors(entries + frozen -> offsets[u], entries + frozen -> offsets[u + 1], removed.data());
+    }
+    return Neighbors(adjList[u], removed.data());
 }
 
-// Checks if the directed graph contains a cycle
-bool Vertex::isCycledDirected() const
+// Pins the in-edges of the current orientation, building the index if needed
+Vertex::InEdges Vertex::inEdges() const
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    std::vector<bool> recStack (sizeVertexs, false);
-    for (int i = 0; i < sizeVertexs; ++i) {
-        if (!visit[i]) {
-            if (dfsCycledDirected(i, visit, recStack)) {
-                return true;
-            } 
-        }
+    if (transposed) {
+        return InEdges {this, nullptr};
     }
-    return false;
+    return InEdges {this, reverseIndex()};
 }
 
-// Helper function for detecting a cycle in a directed graph
-bool Vertex::dfsCycledDirected(int start, std::vector<bool>& visit, std::vector<bool>& recStack) const
+// In-edge index of the stored rows, rebuilt lazily after edge changes
+std::shared_ptr<const Csr<int>> Vertex::reverseIndex() const
 {
-    visit[start] = true;
-    recStack[start] = true;
-    for(auto i : adjList[start]) {
-        if (!visit[i]) {
-            if (dfsCycledDirected(i, visit, recStack)) {
-                return true;
+    return cachedReverse.get(edgeVersion, [this] {
+        return std::make_shared<const Csr<int>>(reverseCsr<int>(
+            sizeVertexs,
+            [this](int u) { return stored(u); },
+            [](int u, int v) { return std::pair<int, int>(v, u); }));
+    });
+}
+
+// Writes a flipped orientation, or restored rows, back into adjList before it is modified
+void Vertex::materialize()
+{
+    if (!transposed) {
+        if (frozen) {
+            for (int u = 0; u < sizeVertexs; ++u) {
+                Neighbors row = frozen -> row(u);
+                adjList[u].assign(row.begin(), row.end());
             }
-        } else if (recStack[i]) {
-            return true;
+            frozen.reset();
+            countSlots();
         }
+        return;
     }
-    recStack[start] = false;
-    return false;
+    frozen.reset();
+    for (int u = 0; u < sizeVertexs; ++u) {
+        Neighbors row = flipped -> row(u);
+        adjList[u].assign(row.begin(), row.end());
+    }
+    countSlots();
+    flipped.reset();
+    transposed = false;
+    ++edgeVersion;
+}
+
+// Checks if the undirected graph contains a cycle
+bool Vertex::isCycledUndirected() const
+{
+    return hasUndirectedCycle(outGraph());
+}
+
+// Checks if the directed graph contains a cycle
+bool Vertex::isCycledDirected() const
+{
+    return cachedCycledDirected.get(mutationVersion, [this] { return computeCycledDirected(); });
+}
+
+// Uncached directed cycle check
+bool Vertex::computeCycledDirected() const
+{
+    return hasDirectedCycle(outGraph());
 }
 
 // Prints the adjacency list
 void Vertex::print() const
 {
-    for(int i = 0; i < adjList.size(); ++i) {
+    for(int i = 0; i < sizeVertexs; ++i) {
         std::cout << i << " : ";
-        for(int j = 0; j < adjList[i].size(); ++j) {
-            std::cout << adjList[i][j] << " ";
+        for(int j : out(i)) {
+            std::cout << j << " ";
         }
         std::cout << std::endl;
     }
@@ -213,59 +423,89 @@ void Vertex::topSort() const
     if (isCycledDirected()) {
         std::cout << "Cycled graph!!" << std::endl;
         return;
-    }  
-    std::vector<bool> visit (sizeVertexs, false);
-    std::stack<int> st;
-    for(int i = 0; i < sizeVertexs; ++i) {
-        if (!visit[i]) {
-            dfsTopSort(i, visit, st);
-        }
     }
-    while(!st.empty()) {
-        std::cout << st.top() << " ";
-        st.pop();
+    for (int x : finishOrder(outGraph())) {
+        std::cout << x << " ";
     }
     std::cout << std::endl;
 }
 
-// DFS helper function for topological sorting
-void Vertex::dfsTopSort(int start, std::vector<bool>& visit, std::stack<int>& st) const
-{
-    visit[start] = true;
-    for(auto i : adjList[start]) {
-        if (!visit[i]) {
-            dfsTopSort(i, visit, st);
-        }
-    }
-    st.push(start);
-}
-
 // Counts the number of vertices at a given level in BFS
 int Vertex::getCountNthLevel(int start, int level) const
 {
     if (level < 0) {
         throw std::invalid_argument("Invalid level!!");
     }
-    std::vector<bool> visit (sizeVertexs, false);
-    std::queue<std::pair<int, int>> q;
-    int count = 0;
-    q.push({start, 0});
-    visit[start] = true;
-    while (!q.empty()) {
-        auto [currVertex, currLevel] = q.front();
-        q.pop();
-        if (currLevel == level) {
-            ++count;
-        } else if (currLevel < level) {
-            for(auto i : adjList[currVertex]) {
-                if (!visit[i]) {
-                    visit[i] = true;
-                    q.push({i, currLevel + 1});
+    GRAPH_SCOPE("Vertex::getCountNthLevel");
+    return static_cast<int>(countAtLevel(outGraph(), start, level));
+}
+
+// Returns the BFS level of every vertex, -1 when unreachable.
+// Direction-optimizing: once the frontier's edges outweigh the unexplored
+// ones, each unvisited vertex scans its in-edges for a parent instead.
+// The level and frontier arrays are placed by the active MemoryPolicy.
+std::vector<int> Vertex::levels(int start) const
+{
+    GRAPH_SCOPE("Vertex::levels");
+    const std::size_t alpha = 14;
+    const std::size_t beta = 24;
+    PolicyArray<int> dist (sizeVertexs, -1);
+    std::size_t unexplored = 0;
+    for (int i = 0; i < sizeVertexs; ++i) {
+        unexplored += out(i).size();
+    }
+
+    InEdges in {};
+    bool bottomUp = false;
+    PolicyArray<int> frontier {start};
+    PolicyArray<int> next;
+    dist[start] = 0;
+    for (int level = 0; !frontier.empty(); ++level) {
+        GRAPH_FRONTIER(frontier.size());
+        std::size_t frontierEdges = 0;
+        for (int x : frontier) {
+            frontierEdges += out(x).size();
+        }
+        unexplored -= frontierEdges;
+        if (!bottomUp && frontierEdges > unexplored / alpha) {
+            bottomUp = true;
+        } else if (bottomUp && frontier.size() < sizeVertexs / beta) {
+            bottomUp = false;
+        }
+
+        next.clear();
+        if (bottomUp) {
+            if (!in.graph) {
+                in = inEdges();
+            }
+            for (int v = 0; v < sizeVertexs; ++v) {
+                if (dist[v] != -1) {
+                    continue;
+                }
+                for (int u : in[v]) {
+                    GRAPH_EDGE();
+                    if (dist[u] == level) {
+                        dist[v] = level + 1;
+                        next.push_back(v);
+                        break;
+                    }
+                }
+            }
+        } else {
+            for (int x : frontier) {
+                GRAPH_VISIT();
+                for (int y : out(x)) {
+                    GRAPH_EDGE();
+                    if (dist[y] == -1) {
+                        dist[y] = level + 1;
+                        next.push_back(y);
+                    }
                 }
             }
         }
+        frontier.swap(next);
     }
-    return count;
+    return std::vector<int>(dist.begin(), dist.end());
 }
 
 // Counts the number of vertices at a given level in DFS
@@ -288,7 +528,7 @@ void Vertex::dfsNthLevel(int start, int currLevel, int level, int& count, std::v
     if (currLevel == level) {
         ++count;
     } else if (currLevel < level) {
-       for (auto i : adjList[start]) {
+       for (auto i : out(start)) {
             if (!visit[i]) {
                 dfsNthLevel(i, currLevel + 1, level, count, visit);
             }
@@ -299,28 +539,7 @@ void Vertex::dfsNthLevel(int start, int currLevel, int level, int& count, std::v
 // Returns all possible paths between two vertices
 std::vector<std::vector<int>> Vertex::getAllPossiblePaths(int src, int dest) const
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    std::vector<int> tmp;
-    std::vector<std::vector<int>> res;
-    dfsAllPaths(src, dest, tmp, res, visit);
-    return res;
-}
-
-// DFS helper function to find all possible paths
-void Vertex::dfsAllPaths(int src, int dest, std::vector<int>& tmp, std::vector<std::vector<int> >& res, std::vector<bool>& visit) const
-{
-    visit[src] = true;
-    tmp.push_back(src);
-    if (src == dest) {
-        res.push_back(tmp);
-    }
-    for(auto i : adjList[src]) {
-        if (!visit[i]) {
-            dfsAllPaths(i, dest, tmp, res, visit);
-        }
-    }
-    tmp.pop_back();
-    visit[src] = false;
+    return allSimplePaths(outGraph(), src, dest);
 }
 
 // Kahn's Algorithm for topological sorting
@@ -329,132 +548,221 @@ std::vector<int> Vertex::Kahn() const
     if (isCycledDirected()) {
         throw std::invalid_argument("Graph is cycled!!");
     }
-    std::vector<int> indegree (sizeVertexs, 0);
-    for(int i = 0; i < sizeVertexs; ++i) {
-        for (auto v : adjList[i]) {
-            ++indegree[v];
-        }
-    } 
-    std::queue<int> q;
-    for(int i = 0; i < indegree.size(); ++i) {
-        if (indegree[i] == 0) {
-            q.push(i);
-        } 
-    }
-    
-    std::vector<int> res;
-    while (!q.empty()) {
-        int tmp = q.front();
-        q.pop();
-        res.push_back(tmp);
-        for(auto u : adjList[tmp]) {
-            indegree[u]--;
-            if (indegree[u] == 0) {
-                q.push(u);
-            }
-        }
-    }
-    return res;
+    return cachedKahn.get(mutationVersion, [this] { return computeKahn(); });
+}
+
+// Uncached Kahn's Algorithm, for graphs already known to be acyclic
+std::vector<int> Vertex::computeKahn() const
+{
+    return kahnOrder(outGraph());
 }
 
 // Kosaraju's Algorithm for Strongly Connected Components (SCCs)
-std::vector<std::vector<int>> Vertex::Kosarajou() 
+// The second pass walks the in-edge index instead of transposing the graph
+std::vector<std::vector<int>> Vertex::Kosarajou() const
 {
-    std::vector<bool> visit (sizeVertexs, false);
-    std::stack<int> st;
-    for(int i = 0; i < sizeVertexs; ++i) {
-        if (!visit[i]) {
-            fillinorder(i, visit, st);
-        }
-    }
+    InEdges in = inEdges();
+    return kosarajuComponents(outGraph(), neighborGraph(
+        sizeVertexs,
+        [&in](int u, auto&& f) {
+            for (int v : in[u]) {
+                f(v, NoWeight {});
+            }
+        },
+        [this](int u) { return removed[u] != 0; }));
+}
 
-    Transpose();
-    visit.assign (sizeVertexs, false);
-    std::vector<std::vector<int>> res;
-    while (!st.empty()) {
-        int tmp = st.top();
-        st.pop();
-        if (!visit[tmp]) {
-            std::vector<int> component;
-            dfsKosarajou(tmp, visit, component);
-            res.push_back(component);
-        }
-    }
-    Transpose();
-    return res;
+// Tarjan's Algorithm for Strongly Connected Components (SCCs)
+std::vector<std::vector<int>> Vertex::TarjansAlgorithm() const
+{
+    return cachedSCCs.get(mutationVersion, [this] { return computeSCCs(); });
 }
 
-// Fills the stack with vertices in finishing order
-void Vertex::fillinorder(int src, std::vector<bool>& visit, std::stack<int>& st) const
+// Uncached Tarjan's Algorithm
+std::vector<std::vector<int>> Vertex::computeSCCs() const
 {
-    visit[src] = true;
-    for(auto u : adjList[src]) {
-        if (!visit[u]) {
-            fillinorder(u, visit, st);
-        }
-    }
-    st.push(src);
+    GRAPH_SCOPE("Vertex::TarjansAlgorithm");
+    return tarjanComponents(outGraph());
 }
 
-// DFS helper function for Kosaraju's Algorithm
-void Vertex::dfsKosarajou(int src, std::vector<bool>& visit, std::vector<int>& vec) const
+// Labels every vertex with the index of its connected component
+std::vector<int> Vertex::componentLabels() const
 {
-    visit[src] = true;
-    vec.push_back(src);
-    for(auto u : adjList[src]) {
-        if (!visit[u]) {
-            dfsKosarajou(u, visit, vec);
-        }
-    }
+    return cachedLabels.get(mutationVersion, [this] { return computeComponentLabels(); });
 }
 
-// Tarjan's Algorithm for Strongly Connected Components (SCCs)
-std::vector<std::vector<int>> Vertex::TarjansAlgorithm() const
+// PageRank by pull iterations over the in-edge index
+PageRankResult Vertex::pageRank(const PageRankOptions& options) const
 {
-    std::vector<std::vector<int>> SCCs;
-    std::vector<bool> onStack(sizeVertexs, false);
-    std::vector<int> ids(sizeVertexs, -1);
-    std::vector<int> lowlink(sizeVertexs, -1);
-    std::stack<int> st;
+    GRAPH_SCOPE("Vertex::pageRank");
+    return pullPageRank(sizeVertexs, inEdges(), uniformTeleport(removed), options);
+}
 
-    for (int i = 0; i < sizeVertexs; ++i) {
-        if (ids[i] == -1) {
-            TarjanHelper(i, ids, lowlink, st, onStack, SCCs);
-        }
+// PageRank whose random jumps land only on 'seeds'
+PageRankResult Vertex::personalizedPageRank(const std::vector<int>& seeds, const PageRankOptions& options) const
+{
+    GRAPH_SCOPE("Vertex::personalizedPageRank");
+    return pullPageRank(sizeVertexs, inEdges(), seedTeleport(removed, seeds), options);
+}
+
+// Uncached connected component labelling by BFS
+std::vector<int> Vertex::computeComponentLabels() const
+{
+    return ::componentLabels(outGraph());
+}
+
+// Writes the graph and its cached results as a checksummed binary snapshot.
+// Rows are written compacted, so tombstones are not carried over.
+void Vertex::save(std::ostream& os) const
+{
+    GRAPH_SCOPE("Vertex::save");
+    CheckpointWriter writer(os, checkpoint_detail::unweightedGraph);
+    writer.put(sizeVertexs);
+    writer.put(mutationVersion);
+    writer.put(edgeVersion);
+    writer.put(static_cast<unsigned char>(transposed));
+    writer.put(compactionRatio);
+    writer.put(static_cast<unsigned char>(backgroundCompaction));
+    writer.putVector(removed);
+    putRows<int>(writer, sizeVertexs, [this](int u) { return stored(u); });
+
+    // The in-edge index of the stored rows, which is also the flipped orientation
+    std::shared_ptr<const Csr<int>> index = flipped;
+    if (!index) {
+        cachedReverse.peek(edgeVersion, index);
+    }
+    writer.put(static_cast<unsigned char>(index != nullptr));
+    if (index) {
+        putCsr(writer, *index);
     }
 
-    return SCCs;
+    bool cycled = false;
+    bool hasCycled = cachedCycledDirected.peek(mutationVersion, cycled);
+    writer.put(static_cast<unsigned char>(hasCycled));
+    writer.put(static_cast<unsigned char>(cycled));
+
+    std::vector<int> order;
+    bool hasOrder = cachedKahn.peek(mutationVersion, order);
+    writer.put(static_cast<unsigned char>(hasOrder));
+    writer.putVector(order);
+
+    // Components are flattened into offsets and vertex ids
+    std::vector<std::vector<int>> components;
+    bool hasComponents = cachedSCCs.peek(mutationVersion, components);
+    std::vector<std::size_t> componentOffsets {0};
+    std::vector<int> componentIds;
+    for (const std::vector<int>& component : components) {
+        componentIds.insert(componentIds.end(), component.begin(), component.end());
+        componentOffsets.push_back(componentIds.size());
+    }
+    writer.put(static_cast<unsigned char>(hasComponents));
+    writer.putVector(componentOffsets);
+    writer.putVector(componentIds);
+
+    std::vector<int> labels;
+    bool hasLabels = cachedLabels.peek(mutationVersion, labels);
+    writer.put(static_cast<unsigned char>(hasLabels));
+    writer.putVector(labels);
+    writer.finish();
 }
 
-// Tarjan's Algorithm helper function
-void Vertex::TarjanHelper(int src, std::vector<int>& ids, std::vector<int>& lowlink, std::stack<int>& st, std::vector<bool>& onStack, std::vector<std::vector<int>>& SCCs) const
+// Replaces this graph with a snapshot from save(). Everything is read and
+// checked before the graph changes, so a corrupt snapshot leaves it intact.
+// The rows are kept as the loaded Csr until the next change needs adjList.
+void Vertex::restore(std::istream& is)
 {
-    static int visitingTime = 0;
-    ids[src] = lowlink[src] = ++visitingTime;
-    st.push(src);
-    onStack[src] = true;
+    GRAPH_SCOPE("Vertex::restore");
+    CheckpointReader reader(is, checkpoint_detail::unweightedGraph);
+    const int n = reader.get<int>();
+    if (n < 0) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    const std::uint64_t mutations = reader.get<std::uint64_t>();
+    const std::uint64_t edges = reader.get<std::uint64_t>();
+    const bool isTransposed = reader.get<unsigned char>() != 0;
+    const double ratio = reader.get<double>();
+    const bool background = reader.get<unsigned char>() != 0;
+    std::vector<unsigned char> removedFlags;
+    reader.getVector(removedFlags);
+    if (removedFlags.size() != static_cast<std::size_t>(n)) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    auto rows = std::make_shared<const Csr<int>>(getCsr<int>(reader, n));
 
-    for (int v : adjList[src]) {
-        if (ids[v] == -1) {
-            TarjanHelper(v, ids, lowlink, st, onStack, SCCs);
-        }
-        if (onStack[v]) {
-            lowlink[src] = std::min(lowlink[src], lowlink[v]);
-        }
+    std::shared_ptr<const Csr<int>> index;
+    if (reader.get<unsigned char>()) {
+        index = std::make_shared<const Csr<int>>(getCsr<int>(reader, n));
+    }
+    if (isTransposed && !index) {
+        throw std::runtime_error("Corrupt checkpoint!!");
     }
 
-    if (lowlink[src] == ids[src]) {
-        std::vector<int> currSCC;
-        while (st.top() != src) {
-            int elem = st.top();
-            currSCC.push_back(elem);
-            st.pop();
-            onStack[elem] = false;
-        }
+    auto inRange = [n](const std::vector<int>& ids) {
+        return std::all_of(ids.begin(), ids.end(), [n](int v) { return v >= 0 && v < n; });
+    };
+    const bool hasCycled = reader.get<unsigned char>() != 0;
+    const bool cycled = reader.get<unsigned char>() != 0;
+
+    const bool hasOrder = reader.get<unsigned char>() != 0;
+    std::vector<int> order;
+    reader.getVector(order);
+
+    const bool hasComponents = reader.get<unsigned char>() != 0;
+    std::vector<std::size_t> componentOffsets;
+    std::vector<int> componentIds;
+    reader.getVector(componentOffsets);
+    reader.getVector(componentIds);
+    bool valid = inRange(order) && inRange(componentIds)
+        && !componentOffsets.empty() && componentOffsets.front() == 0 && componentOffsets.back() == componentIds.size()
+        && std::is_sorted(componentOffsets.begin(), componentOffsets.end());
+
+    const bool hasLabels = reader.get<unsigned char>() != 0;
+    std::vector<int> labels;
+    reader.getVector(labels);
+    valid = valid && (!hasLabels || labels.size() == static_cast<std::size_t>(n));
+    if (!valid) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    reader.finish();
 
-        currSCC.push_back(st.top());
-        onStack[st.top()] = false;
-        st.pop();
-        SCCs.push_back(currSCC);
+    std::vector<std::vector<int>> components;
+    for (std::size_t c = 0; c + 1 < componentOffsets.size(); ++c) {
+        components.emplace_back(componentIds.begin() + componentOffsets[c], componentIds.begin() + componentOffsets[c + 1]);
     }
-}
\ No newline at end of file
+
+    finishCompaction();
+    std::pmr::vector<AdjRow> empty (n, adjList.get_allocator());
+    adjList.swap(empty);
+    sizeVertexs = n;
+    frozen = std::move(rows);
+    removed = std::move(removedFlags);
+    storedSlots = frozen -> entries.size();
+    deadSlots = 0;
+    mutationVersion = mutations;
+    edgeVersion = edges;
+    compactionRatio = ratio;
+    backgroundCompaction = background;
+    transposed = isTransposed;
+    flipped = isTransposed ? index : nullptr;
+
+    cachedReverse.clear();
+    cachedCycledDirected.clear();
+    cachedKahn.clear();
+    cachedSCCs.clear();
+    cachedLabels.clear();
+    if (index) {
+        cachedReverse.put(edgeVersion, index);
+    }
+    if (hasCycled) {
+        cachedCycledDirected.put(mutationVersion, cycled);
+    }
+    if (hasOrder) {
+        cachedKahn.put(mutationVersion, std::move(order));
+    }
+    if (hasComponents) {
+        cachedSCCs.put(mutationVersion, std::move(components));
+    }
+    if (hasLabels) {
+        cachedLabels.put(mutationVersion, std::move(labels));
+    }
+}
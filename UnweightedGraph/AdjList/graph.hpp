@@ -1,21 +1,82 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <memory_resource>
 #include <vector>
 #include <stack>
+#include "../../common/csr.hpp"
+#include "../../common/pagerank.hpp"
+#include "../../common/pending_result.hpp"
+#include "../../common/versioned_value.hpp"
 
 // Constructor
 class Vertex 
 {
 public:
-    Vertex(int n);
+    // Adjacency row type; rows allocate from the graph's memory resource
+    using AdjRow = std::pmr::vector<int>;
+
+    // Read-only view of one vertex's neighbors
+    using Neighbors = NeighborRange<int>;
+
+    // Edge storage comes from 'resource', e.g. an EdgeArena
+    Vertex(int n, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Copies and moves wait for a background compaction of the source first
+    Vertex(const Vertex&) = default;
+    Vertex(Vertex&&) = default;
+    Vertex& operator=(const Vertex&) = default;
+    Vertex& operator=(Vertex&&) = default;
+    ~Vertex();
 
     // Adds an edge between two vertices
     void addEdge(int u, int v);
 
+    // Adds a directed edge from u to v
+    void addDirectedEdge(int u, int v);
+
     // Adds a new vertex
     void addVertex();
 
+    // Removes one edge between u and v in O(deg u + deg v); returns false when there is none
+    bool removeEdge(int u, int v);
+
+    // Removes one directed edge from u to v in O(deg u); returns false when there is none
+    bool removeDirectedEdge(int u, int v);
+
+    // Removes vertex v and its edges in O(out-degree of v); the ids of other vertices do not change
+    void removeVertex(int v);
+
+    // Checks whether vertex v has been removed
+    bool isRemoved(int v) const;
+
+    // Rewrites the rows without tombstones and frees the rows of removed vertices
+    void compact();
+
+    // Runs compact() on a worker thread; const queries may run meanwhile and the next change installs the result
+    void compactInBackground();
+
+    // Installs a background compaction, waiting for it if needed
+    void finishCompaction();
+
+    // Compacts once tombstones exceed 'ratio' of the stored edge slots, in the background when asked
+    void setCompactionThreshold(double ratio, bool background = false);
+
+    // Returns the number of vertices
+    int size() const;
+
+    // Returns the adjacency list of vertex u
+    Neighbors neighbors(int u) const;
+
+    // Returns the vertices with an edge into u, from the lazily built in-edge index
+    Neighbors inNeighbors(int u) const;
+
+    // Returns the mutation version, bumped by every structural change
+    std::uint64_t version() const;
+
     // Depth First Search (DFS) iterative method
     void DFS(int start) const;
 
@@ -31,7 +92,7 @@ public:
     // Returns the shortest path between vertices u and v
     std::vector<int> getShortPath(int u, int v);
 
-    // Transposes the graph (reverse all edges)
+    // Transposes the graph (reverse all edges) by flipping to the in-edge index
     void Transpose();
 
     // Checks if the undirected graph contains a cycle
@@ -46,6 +107,9 @@ public:
     // Counts the number of vertices at a given level in BFS
     int getCountNthLevel(int start, int level) const;
 
+    // Returns the BFS level of every vertex (-1 when unreachable), switching to bottom-up steps on large frontiers
+    std::vector<int> levels(int start) const;
+
     // Counts the number of vertices at a given level in DFS
     int getCountNthLevelWithDFS(int start, int level) const;
 
@@ -56,41 +120,112 @@ public:
     std::vector<int> Kahn() const;
 
     // Kosaraju's algorithm for finding strongly connected components
-    std::vector<std::vector<int>> Kosarajou();
+    std::vector<std::vector<int>> Kosarajou() const;
 
     // Tarjan's algorithm for finding strongly connected components
     std::vector<std::vector<int>> TarjansAlgorithm() const;
 
+    // Labels every vertex with the index of its connected component
+    std::vector<int> componentLabels() const;
+
+    // PageRank by pull iterations over the in-edge index, until the L1 change drops below options.tolerance
+    PageRankResult pageRank(const PageRankOptions& options = {}) const;
+
+    // PageRank whose random jumps land only on 'seeds'
+    PageRankResult personalizedPageRank(const std::vector<int>& seeds, const PageRankOptions& options = {}) const;
+
+    // Writes the graph and its cached results as a checksummed binary snapshot
+    void save(std::ostream& os) const;
+
+    // Replaces this graph with a snapshot from save(), caches included; throws std::runtime_error when it is corrupt
+    void restore(std::istream& is);
+
 private:
+    // Declared first so copies, moves and assignments wait for it before touching the rows
+    PendingResult<std::pmr::vector<AdjRow>> pendingCompaction;
+
     int sizeVertexs;
-    std::vector<std::vector<int>> adjList; 
+    std::pmr::vector<AdjRow> adjList;
+    std::uint64_t mutationVersion;
 
-    // DFS helper function
-    void dfsHelper(int start, std::vector<bool>& visit) const;
+    // Rows loaded by restore(), read in place until the first change copies them into adjList
+    std::shared_ptr<const Csr<int>> frozen;
 
-    // Helper function for detecting a cycle in an undirected graph
-    bool dfsCycledUndirected(int start, std::vector<bool>& visit, int perent) const;
+    // Bumped only when the stored rows change; keys the in-edge index
+    std::uint64_t edgeVersion;
 
-    // Helper function for detecting a cycle in a directed graph
-    bool dfsCycledDirected(int start, std::vector<bool>& visit, std::vector<bool>& recStack) const;
+    // While transposed, out-edges are read from 'flipped', the in-edge index of the stored rows
+    bool transposed;
+    std::shared_ptr<const Csr<int>> flipped;
+    VersionedValue<std::shared_ptr<const Csr<int>>> cachedReverse;
 
-    // DFS helper function for topological sorting
-    void dfsTopSort(int start, std::vector<bool>& visit, std::stack<int>& st) const;
+    // Tombstones: a removed vertex is flagged here, a removed edge slot holds -1
+    std::vector<unsigned char> removed;
+    std::size_t storedSlots;
+    std::size_t deadSlots;
+    // Live stored slots pointing at each vertex, so removeVertex() can count what it kills;
+    // kept only while adjList holds the rows, countSlots() rebuilds it otherwise
+    std::vector<int> liveSlotsInto;
+    double compactionRatio;
+    bool backgroundCompaction;
 
-    // DFS helper function to count vertices at a specific level
-    void dfsNthLevel(int start, int currLevel, int level, int& count, std::vector<bool>& visit) const;
+    // In-edges of the current orientation, pinned for one algorithm run
+    struct InEdges
+    {
+        const Vertex* graph = nullptr;
+        std::shared_ptr<const Csr<int>> index;      // null when the stored rows are the in-edges
+
+        Neighbors operator[](int u) const { return index ? index -> row(u) : graph -> stored(u); }
+    };
+
+    // Out-edges of u in the current orientation
+    Neighbors out(int u) const;
+
+    // out(u) as a graph for the common/graph_kernels.hpp algorithms; defined in graph.cpp
+    auto outGraph() const;
+
+    // Live entries of the stored row of u
+    Neighbors stored(int u) const;
 
-    // DFS helper function for finding all paths between two vertices
-    void dfsAllPaths(int src, int dest, std::vector<int>& tmp, std::vector<std::vector<int> >& res, std::vector<bool>& visit) const;
+    // Pins the in-edges of the current orientation
+    InEdges inEdges() const;
 
-    // Helper function to fill the stack for Kosaraju's algorithm
-    void fillinorder(int src, std::vector<bool>& visit, std::stack<int>& st) const;
+    // In-edge index of the stored rows
+    std::shared_ptr<const Csr<int>> reverseIndex() const;
 
-    // DFS helper function for Kosaraju's algorithm
-    void dfsKosarajou(int src, std::vector<bool>& visit, std::vector<int>& vec) const;
+    // Writes a flipped orientation back into the rows before they are modified
+    void materialize();
 
-    // Tarjan's algorithm helper function
-    void TarjanHelper(int src, std::vector<int>& ids, std::vector<int>& lowlink, std::stack<int>& st, std::vector<bool>& onStack, std::vector<std::vector<int>>& SCCs) const;
+    // Settles pending compaction and orientation before the stored rows change
+    void beginChange();
+
+    // Marks the first stored slot u -> v as deleted, scanning the row of u
+    bool tombstone(int u, int v);
+
+    // Publishes a removal and compacts once tombstones pass the threshold
+    void afterRemoval();
+
+    // Live copy of the stored rows
+    std::pmr::vector<AdjRow> compactedRows() const;
+
+    // Replaces the stored rows with compacted ones holding the same edges
+    void installRows(std::pmr::vector<AdjRow> rows);
+    void countSlots();
+
+    // Whole-graph results memoized against mutationVersion
+    VersionedValue<bool> cachedCycledDirected;
+    VersionedValue<std::vector<int>> cachedKahn;
+    VersionedValue<std::vector<std::vector<int>>> cachedSCCs;
+    VersionedValue<std::vector<int>> cachedLabels;
+
+    // Uncached implementations behind the memoized queries
+    bool computeCycledDirected() const;
+    std::vector<int> computeKahn() const;
+    std::vector<std::vector<int>> computeSCCs() const;
+    std::vector<int> computeComponentLabels() const;
+
+    // DFS helper function to count vertices at a specific level
+    void dfsNthLevel(int start, int currLevel, int level, int& count, std::vector<bool>& visit) const;
 
 };
 
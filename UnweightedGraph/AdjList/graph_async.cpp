@@ -0,0 +1,15 @@
+#include "graph_async.hpp"
+#include "graph.hpp"
+#include "../../common/graph_kernels_async.hpp"
+
+// Kosaraju's algorithm for strongly connected components, without transposing the graph
+Task<std::vector<std::vector<int>>> KosarajouAsync(const Vertex& graph, AsyncContext ctx)
+{
+    return kosarajuAsync(graph, [&graph](int u) { return graph.neighbors(u); }, std::move(ctx));
+}
+
+// Returns all possible paths between two vertices
+Task<std::vector<std::vector<int>>> getAllPossiblePathsAsync(const Vertex& graph, int src, int dest, AsyncContext ctx)
+{
+    return allSimplePathsAsync(graph, [&graph](int u) { return graph.neighbors(u); }, src, dest, std::move(ctx));
+}
@@ -0,0 +1,20 @@
+#ifndef GRAPH_ASYNC_H
+#define GRAPH_ASYNC_H
+
+// Coroutine versions of the long-running Vertex algorithms. Requires C++20.
+// Each one yields to its executor every ctx.yieldEvery edges, reports
+// progress through ctx.progress and stops with OperationCancelled once
+// ctx.stop is requested. The graph must not change while a task runs.
+
+#include <vector>
+#include "../../common/async.hpp"
+
+class Vertex;
+
+// Kosaraju's algorithm for strongly connected components, without transposing the graph
+Task<std::vector<std::vector<int>>> KosarajouAsync(const Vertex& graph, AsyncContext ctx);
+
+// Returns all possible paths between two vertices
+Task<std::vector<std::vector<int>>> getAllPossiblePathsAsync(const Vertex& graph, int src, int dest, AsyncContext ctx);
+
+#endif
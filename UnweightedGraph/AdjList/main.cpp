@@ -1,5 +1,6 @@
 #include <iostream>
 #include "graph.hpp"
+#include "reachability.hpp"
 
 int main() {
     // Create a graph with 5 vertices
@@ -71,6 +72,10 @@ int main() {
         std::cout << std::endl;
     }
 
+    // Build a reachability index and query it
+    ReachabilityIndex index(graph);
+    std::cout << "Can 0 reach 3: " << (index.reachable(0, 3) ? "Yes" : "No") << std::endl;
+
     // Perform Kahn's algorithm for topological sorting
     std::vector<int> kahnOrder = graph.Kahn();
     std::cout << "Topological Sorting using Kahn's Algorithm:" << std::endl;
@@ -0,0 +1,236 @@
+#include "reachability.hpp"
+#include "graph.hpp"
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+const std::uint32_t indexMagic = 0x4C525247;   // "GRRL"
+const std::uint32_t indexVersion = 1;
+
+template <typename T>
+void writeVector(std::ostream& os, const std::vector<T>& vec)
+{
+    std::uint64_t n = vec.size();
+    os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    os.write(reinterpret_cast<const char*>(vec.data()), n * sizeof(T));
+}
+
+template <typename T>
+void readVector(std::istream& is, std::vector<T>& vec)
+{
+    std::uint64_t n = 0;
+    if (!is.read(reinterpret_cast<char*>(&n), sizeof(n)) || n > (std::uint64_t(1) << 40)) {
+        throw std::runtime_error("Corrupt reachability index!!");
+    }
+    vec.resize(n);
+    if (!is.read(reinterpret_cast<char*>(vec.data()), n * sizeof(T))) {
+        throw std::runtime_error("Corrupt reachability index!!");
+    }
+}
+
+} // namespace
+
+// Builds the index from the SCCs found by TarjansAlgorithm()
+ReachabilityIndex::ReachabilityIndex(const Vertex& graph, int traversals, unsigned seed)
+    : traversals {std::max(1, traversals)}
+{
+    const int n = graph.size();
+    std::vector<std::vector<int>> SCCs = graph.TarjansAlgorithm();
+    const int C = static_cast<int>(SCCs.size());
+    component.assign(n, -1);
+    for (int c = 0; c < C; ++c) {
+        for (int v : SCCs[c]) {
+            component[v] = c;
+        }
+    }
+
+    // Condensation DAG without duplicate edges. Tarjan finishes a component
+    // after all components it reaches, so targets always have lower ids.
+    offsets.assign(C + 1, 0);
+    std::vector<int> indegree(C, 0);
+    std::vector<int> seen(C, -1);
+    for (int c = 0; c < C; ++c) {
+        for (int u : SCCs[c]) {
+            for (int v : graph.neighbors(u)) {
+                int d = component[v];
+                if (d != c && seen[d] != c) {
+                    seen[d] = c;
+                    targets.push_back(d);
+                    ++indegree[d];
+                }
+            }
+        }
+        offsets[c + 1] = static_cast<int>(targets.size());
+    }
+
+    height.assign(C, 0);
+    for (int c = 0; c < C; ++c) {
+        for (int k = offsets[c]; k < offsets[c + 1]; ++k) {
+            height[c] = std::max(height[c], height[targets[k]] + 1);
+        }
+    }
+
+    // Randomized post-order interval labels, one pass per traversal
+    labels.assign(std::size_t(C) * this->traversals * 2, 0);
+    std::mt19937 rng(seed);
+    std::vector<int> roots;
+    for (int c = 0; c < C; ++c) {
+        if (indegree[c] == 0) {
+            roots.push_back(c);
+        }
+    }
+    std::vector<int> order = targets;
+    std::vector<bool> visit(C);
+    std::vector<std::pair<int, int>> frames;
+    for (int t = 0; t < this->traversals; ++t) {
+        if (t > 0) {
+            std::shuffle(roots.begin(), roots.end(), rng);
+            for (int c = 0; c < C; ++c) {
+                std::shuffle(order.begin() + offsets[c], order.begin() + offsets[c + 1], rng);
+            }
+        }
+        visit.assign(C, false);
+        std::uint32_t post = 0;
+        for (int root : roots) {
+            frames.push_back({root, offsets[root]});
+            visit[root] = true;
+            std::uint32_t* rootLabel = &labels[(std::size_t(root) * this->traversals + t) * 2];
+            rootLabel[0] = UINT32_MAX;
+            while (!frames.empty()) {
+                auto& [c, next] = frames.back();
+                std::uint32_t* label = &labels[(std::size_t(c) * this->traversals + t) * 2];
+                if (next < offsets[c + 1]) {
+                    int d = order[next++];
+                    std::uint32_t* child = &labels[(std::size_t(d) * this->traversals + t) * 2];
+                    if (!visit[d]) {
+                        visit[d] = true;
+                        child[0] = UINT32_MAX;
+                        frames.push_back({d, offsets[d]});
+                    } else {
+                        label[0] = std::min(label[0], child[0]);
+                    }
+                    continue;
+                }
+                label[1] = ++post;
+                label[0] = std::min(label[0], label[1]);
+                int done = c;
+                frames.pop_back();
+                if (!frames.empty()) {
+                    int p = frames.back().first;
+                    std::uint32_t* parent = &labels[(std::size_t(p) * this->traversals + t) * 2];
+                    parent[0] = std::min(parent[0], labels[(std::size_t(done) * this->traversals + t) * 2]);
+                }
+            }
+        }
+    }
+}
+
+// Checks whether every label of component b nests inside those of a
+bool ReachabilityIndex::mayReach(int a, int b) const
+{
+    if (height[a] <= height[b]) {
+        return false;
+    }
+    const std::uint32_t* la = &labels[std::size_t(a) * traversals * 2];
+    const std::uint32_t* lb = &labels[std::size_t(b) * traversals * 2];
+    for (int t = 0; t < traversals; ++t) {
+        if (lb[2 * t] < la[2 * t] || lb[2 * t + 1] > la[2 * t + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks whether v can be reached from u (every vertex reaches itself)
+bool ReachabilityIndex::reachable(int u, int v) const
+{
+    int cu = component[u], cv = component[v];
+    if (cu < 0 || cv < 0) {
+        return false;
+    }
+    if (cu == cv) {
+        return true;
+    }
+    if (!mayReach(cu, cv)) {
+        return false;
+    }
+
+    // Labels cannot rule it out: DFS, pruning every branch the labels reject
+    thread_local std::vector<std::uint32_t> stamp;
+    thread_local std::uint32_t query = 0;
+    if (stamp.size() < height.size()) {
+        stamp.assign(height.size(), 0);
+        query = 0;
+    }
+    if (++query == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        query = 1;
+    }
+    std::vector<int> st {cu};
+    stamp[cu] = query;
+    while (!st.empty()) {
+        int c = st.back();
+        st.pop_back();
+        for (int k = offsets[c]; k < offsets[c + 1]; ++k) {
+            int d = targets[k];
+            if (d == cv) {
+                return true;
+            }
+            if (stamp[d] != query && mayReach(d, cv)) {
+                stamp[d] = query;
+                st.push_back(d);
+            }
+        }
+    }
+    return false;
+}
+
+// Writes the index in a binary format
+void ReachabilityIndex::save(std::ostream& os) const
+{
+    std::uint32_t header[3] = {indexMagic, indexVersion, static_cast<std::uint32_t>(traversals)};
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writeVector(os, component);
+    writeVector(os, height);
+    writeVector(os, labels);
+    writeVector(os, offsets);
+    writeVector(os, targets);
+}
+
+// Reads an index written by save()
+ReachabilityIndex ReachabilityIndex::load(std::istream& is)
+{
+    std::uint32_t header[3] = {};
+    if (!is.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != indexMagic) {
+        throw std::runtime_error("Not a reachability index!!");
+    }
+    if (header[1] != indexVersion) {
+        throw std::runtime_error("Unsupported reachability index version!!");
+    }
+    ReachabilityIndex idx;
+    idx.traversals = static_cast<int>(header[2]);
+    readVector(is, idx.component);
+    readVector(is, idx.height);
+    readVector(is, idx.labels);
+    readVector(is, idx.offsets);
+    readVector(is, idx.targets);
+    const std::size_t C = idx.height.size();
+    if (idx.traversals < 1 || idx.offsets.size() != C + 1 || idx.labels.size() != C * idx.traversals * 2) {
+        throw std::runtime_error("Corrupt reachability index!!");
+    }
+    // Ids index the labels and the condensation rows: removed vertices hold -1,
+    // the rows must tile the targets, and every target must be a component
+    const int components = static_cast<int>(C);
+    auto isComponent = [components](int c) { return c >= 0 && c < components; };
+    if (C > static_cast<std::size_t>(INT_MAX)
+        || std::any_of(idx.component.begin(), idx.component.end(), [&](int c) { return c != -1 && !isComponent(c); })
+        || idx.offsets.front() != 0 || static_cast<std::size_t>(idx.offsets.back()) != idx.targets.size()
+        || !std::is_sorted(idx.offsets.begin(), idx.offsets.end())
+        || !std::all_of(idx.targets.begin(), idx.targets.end(), isComponent)) {
+        throw std::runtime_error("Corrupt reachability index!!");
+    }
+    return idx;
+}
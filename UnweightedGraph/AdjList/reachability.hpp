@@ -0,0 +1,57 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+class Vertex;
+
+// GRAIL-style reachability index on the SCC condensation of a directed graph.
+//
+// Every component gets 'traversals' interval labels [low, post] from randomized
+// post-order DFS runs over the condensation DAG, plus its height above the sinks.
+// If u reaches v then every label of v nests inside the matching label of u and
+// u sits higher than v, so most negative queries are answered from the labels
+// alone; the rest fall back to a DFS that prunes with the same test.
+class ReachabilityIndex
+{
+public:
+    // Builds the index from the SCCs found by TarjansAlgorithm()
+    explicit ReachabilityIndex(const Vertex& graph, int traversals = 3, unsigned seed = 1);
+
+    // Checks whether 'v' can be reached from 'u' (every live vertex reaches
+    // itself); false when either one is removed
+    bool reachable(int u, int v) const;
+
+    // Number of vertices
+    int size() const { return static_cast<int>(component.size()); }
+
+    // Number of strongly connected components
+    int componentCount() const { return static_cast<int>(height.size()); }
+
+    // Component id of vertex 'v', -1 for a removed vertex
+    int componentOf(int v) const { return component[v]; }
+
+    // Writes the index in a binary format
+    void save(std::ostream& os) const;
+
+    // Reads an index written by save(); throws std::runtime_error on bad input
+    static ReachabilityIndex load(std::istream& is);
+
+private:
+    ReachabilityIndex() = default;
+
+    int traversals = 0;
+    std::vector<int> component;
+    std::vector<int> height;
+    std::vector<std::uint32_t> labels;   // [low, post] pairs, 'traversals' per component
+    std::vector<int> offsets;            // condensation DAG in CSR form
+    std::vector<int> targets;
+
+    // Checks whether every label of component 'b' nests inside those of 'a'
+    bool mayReach(int a, int b) const;
+};
+
+#endif
@@ -0,0 +1,387 @@
+#include "snapshot_graph.hpp"
+#include "graph.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+using Level = SnapshotGraph::Level;
+
+// Indexes 'level' by vertex once it has a row for at least a quarter of the
+// vertices it spans, so readers look rows up directly instead of searching;
+// a sparser level gets a bitmap that rules out most vertices without a search
+Level indexed(Level level)
+{
+    if (level.rows.empty()) {
+        return level;
+    }
+    if (level.rows.size() * 4 < static_cast<std::size_t>(level.rows.back()) + 1) {
+        level.present.assign(level.rows.back() / 64 + 1, 0);
+        for (int u : level.rows) {
+            level.present[u / 64] |= std::uint64_t(1) << (u % 64);
+        }
+        return level;
+    }
+    std::vector<std::size_t> offsets (level.rows.back() + 2, 0);
+    for (std::size_t i = 0; i < level.rows.size(); ++i) {
+        offsets[level.rows[i] + 1] = level.offsets[i + 1] - level.offsets[i];
+    }
+    for (std::size_t u = 1; u < offsets.size(); ++u) {
+        offsets[u] += offsets[u - 1];
+    }
+    level.dense = true;
+    level.rows.clear();
+    level.offsets.swap(offsets);
+    return level;
+}
+
+// Walks the non-empty rows of a level in vertex order
+class RowCursor
+{
+public:
+    explicit RowCursor(const Level& level) : level(level) { skipEmpty(); }
+
+    bool done() const { return i >= (level.dense ? level.offsets.size() - 1 : level.rows.size()); }
+    int vertex() const { return level.dense ? static_cast<int>(i) : level.rows[i]; }
+    const int* first() const { return level.targets.data() + level.offsets[i]; }
+    const int* last() const { return level.targets.data() + level.offsets[i + 1]; }
+    void next() { ++i; skipEmpty(); }
+
+private:
+    const Level& level;
+    std::size_t i = 0;
+
+    void skipEmpty()
+    {
+        while (level.dense && !done() && level.offsets[i] == level.offsets[i + 1]) {
+            ++i;
+        }
+    }
+};
+
+// Level holding 'arcs', each vertex's arcs in the order they were added
+Level levelOf(std::vector<std::pair<int, int>> arcs)
+{
+    std::stable_sort(arcs.begin(), arcs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    Level level;
+    level.offsets.push_back(0);
+    level.targets.reserve(arcs.size());
+    for (const auto& [u, v] : arcs) {
+        if (level.rows.empty() || level.rows.back() != u) {
+            level.rows.push_back(u);
+            level.offsets.push_back(level.offsets.back());
+        }
+        level.targets.push_back(v);
+        ++level.offsets.back();
+    }
+    return indexed(std::move(level));
+}
+
+// Level with the arcs of 'older' followed, row by row, by those of 'newer'
+Level merged(const Level& older, const Level& newer)
+{
+    Level level;
+    level.offsets.push_back(0);
+    level.targets.reserve(older.targets.size() + newer.targets.size());
+    RowCursor a (older), b (newer);
+    while (!a.done() || !b.done()) {
+        const bool fromOlder = b.done() || (!a.done() && a.vertex() <= b.vertex());
+        const bool fromNewer = a.done() || (!b.done() && b.vertex() <= a.vertex());
+        level.rows.push_back(fromOlder ? a.vertex() : b.vertex());
+        if (fromOlder) {
+            level.targets.insert(level.targets.end(), a.first(), a.last());
+            a.next();
+        }
+        if (fromNewer) {
+            level.targets.insert(level.targets.end(), b.first(), b.last());
+            b.next();
+        }
+        level.offsets.push_back(level.targets.size());
+    }
+    return indexed(std::move(level));
+}
+
+// CSR rows of every vertex of 'state', its levels folded in
+std::shared_ptr<const Csr<int>> folded(const SnapshotGraph::Version& state)
+{
+    auto base = std::make_shared<Csr<int>>();
+    base->offsets.assign(state.sizeVertexs + 1, 0);
+    for (int u = 0; u < state.sizeVertexs; ++u) {
+        base->offsets[u + 1] = base->offsets[u] + SnapshotGraph::Range(&state, u).size();
+    }
+    base->entries.reserve(base->offsets[state.sizeVertexs]);
+    for (int u = 0; u < state.sizeVertexs; ++u) {
+        for (int v : SnapshotGraph::Range(&state, u)) {
+            base->entries.push_back(v);
+        }
+    }
+    return base;
+}
+
+}
+
+// Arcs of vertex u in this level
+std::pair<const int*, const int*> SnapshotGraph::Level::row(int u) const
+{
+    if (dense) {
+        if (static_cast<std::size_t>(u) + 1 >= offsets.size()) {
+            return {nullptr, nullptr};
+        }
+        return {targets.data() + offsets[u], targets.data() + offsets[u + 1]};
+    }
+    if (static_cast<std::size_t>(u / 64) >= present.size() || !(present[u / 64] >> (u % 64) & 1)) {
+        return {nullptr, nullptr};
+    }
+    auto it = std::lower_bound(rows.begin(), rows.end(), u);
+    const std::size_t i = it - rows.begin();
+    return {targets.data() + offsets[i], targets.data() + offsets[i + 1]};
+}
+
+// Moves to the next arc, past empty parts; null once all are read
+void SnapshotGraph::Range::iterator::settle()
+{
+    while (p == last) {
+        if (segment > state->levels.size()) {
+            p = last = nullptr;
+            return;
+        }
+        if (segment == 0) {
+            const Csr<int>& base = *state->base;
+            if (u < base.rows()) {
+                p = base.entries.data() + base.offsets[u];
+                last = base.entries.data() + base.offsets[u + 1];
+            }
+        } else {
+            std::tie(p, last) = state->levels[segment - 1]->row(u);
+        }
+        ++segment;
+    }
+}
+
+// Number of neighbors
+std::size_t SnapshotGraph::Range::size() const
+{
+    std::size_t count = 0;
+    if (u < state->base->rows()) {
+        count = state->base->offsets[u + 1] - state->base->offsets[u];
+    }
+    for (const auto& level : state->levels) {
+        auto [first, last] = level->row(u);
+        count += last - first;
+    }
+    return count;
+}
+
+// Constructor for an empty graph with n vertices
+SnapshotGraph::SnapshotGraph(int n, std::size_t publishThreshold, std::chrono::milliseconds maxDelay)
+    : current {new Version {0, n, std::make_shared<const Csr<int>>(Csr<int> {std::vector<std::size_t>(n + 1, 0), {}}), {}}}
+    , deltaVertexs {n}
+    , publishThreshold {publishThreshold}
+    , maxDelay {maxDelay}
+    , stopping {false}
+{
+    flusher = std::thread([this] { flushLoop(); });
+}
+
+// Constructor that publishes the current contents of 'graph'
+SnapshotGraph::SnapshotGraph(const Vertex& graph, std::size_t publishThreshold, std::chrono::milliseconds maxDelay)
+    : SnapshotGraph(graph.size(), publishThreshold, maxDelay)
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    for (int u = 0; u < graph.size(); ++u) {
+        for (int v : graph.neighbors(u)) {
+            delta.push_back({u, v});
+        }
+    }
+    publishLocked();
+}
+
+SnapshotGraph::~SnapshotGraph()
+{
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stopping = true;
+    }
+    flushWake.notify_one();
+    flusher.join();
+    delete current.load();
+}
+
+// Adds an undirected edge to the delta
+void SnapshotGraph::addEdge(int u, int v)
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    append(u, v);
+    append(v, u);
+}
+
+// Adds a directed edge from u to v to the delta
+void SnapshotGraph::addDirectedEdge(int u, int v)
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    append(u, v);
+}
+
+// Adds a new vertex to the delta
+void SnapshotGraph::addVertex()
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    changed();
+    ++deltaVertexs;
+}
+
+// Publishes the delta as a new version
+void SnapshotGraph::publish()
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    publishLocked();
+}
+
+// Pins the latest published version
+SnapshotGraph::Snapshot SnapshotGraph::pin() const
+{
+    EpochManager::Guard guard = epochs.pin();
+    const Version* state = current.load();
+    return Snapshot(std::move(guard), state);
+}
+
+// Number of edges waiting in the delta
+std::size_t SnapshotGraph::pendingEdges() const
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return delta.size();
+}
+
+// Appends one arc; publishes when the delta is large enough
+void SnapshotGraph::append(int u, int v)
+{
+    if (u < 0 || v < 0 || u >= deltaVertexs || v >= deltaVertexs) {
+        throw std::out_of_range("Invalid vertex!!");
+    }
+    changed();
+    delta.push_back({u, v});
+    if (delta.size() >= publishThreshold) {
+        publishLocked();
+    }
+}
+
+// Starts the maxDelay clock when the first unpublished change arrives
+void SnapshotGraph::changed()
+{
+    if (!hasPending()) {
+        pendingSince = std::chrono::steady_clock::now();
+        flushWake.notify_one();
+    }
+}
+
+// Checks whether the delta holds edges or vertices not yet published
+bool SnapshotGraph::hasPending() const
+{
+    return !delta.empty() || deltaVertexs != current.load()->sizeVertexs;
+}
+
+// Builds the next version, sharing the base and the older levels with the last one
+void SnapshotGraph::publishLocked()
+{
+    const Version* old = current.load();
+    Version* next = new Version {old->number + 1, deltaVertexs, old->base, old->levels};
+    if (!delta.empty()) {
+        std::vector<std::shared_ptr<const Level>>& levels = next->levels;
+        levels.push_back(std::make_shared<const Level>(levelOf(std::move(delta))));
+        while (levels.size() >= 2 && levels[levels.size() - 2]->targets.size() <= 2 * levels.back()->targets.size()) {
+            auto level = std::make_shared<const Level>(merged(*levels[levels.size() - 2], *levels.back()));
+            levels.pop_back();
+            levels.back() = std::move(level);
+        }
+        std::size_t levelArcs = 0;
+        for (const auto& level : levels) {
+            levelArcs += level->targets.size();
+        }
+        if (levelArcs > next->base->entries.size() / 4) {
+            next->base = folded(*next);
+            levels.clear();
+        }
+    }
+    delta.clear();
+
+    current.store(next);
+    epochs.retire([old] { delete old; });
+    epochs.collect();
+}
+
+// Background thread: publishes a delta once it is maxDelay old
+void SnapshotGraph::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(writerMutex);
+    while (!stopping) {
+        if (!hasPending()) {
+            flushWake.wait(lock);
+        } else if (std::chrono::steady_clock::now() - pendingSince >= maxDelay) {
+            publishLocked();
+        } else {
+            flushWake.wait_until(lock, pendingSince + maxDelay);
+        }
+    }
+}
+
+// Breadth First Search order from start
+std::vector<int> SnapshotGraph::Snapshot::BFS(int start) const
+{
+    return bfsOrder(*this, start);
+}
+
+// Iterative Depth First Search order from start
+std::vector<int> SnapshotGraph::Snapshot::DFS(int start) const
+{
+    return dfsOrder(*this, start);
+}
+
+// Returns the shortest path between vertices u and v
+std::vector<int> SnapshotGraph::Snapshot::getShortPath(int u, int v) const
+{
+    return hopPath(*this, u, v);
+}
+
+// Counts the number of vertices at a given level in BFS
+int SnapshotGraph::Snapshot::getCountNthLevel(int start, int level) const
+{
+    if (level < 0) {
+        throw std::invalid_argument("Invalid level!!");
+    }
+    return static_cast<int>(countAtLevel(*this, start, level));
+}
+
+// Checks if the undirected graph contains a cycle
+bool SnapshotGraph::Snapshot::isCycledUndirected() const
+{
+    return hasUndirectedCycle(*this);
+}
+
+// Checks if the directed graph contains a cycle
+bool SnapshotGraph::Snapshot::isCycledDirected() const
+{
+    return hasDirectedCycle(*this);
+}
+
+// Kahn's algorithm for topological sorting
+std::vector<int> SnapshotGraph::Snapshot::Kahn() const
+{
+    std::vector<int> order = kahnOrder(*this);
+    if (order.size() != static_cast<std::size_t>(size())) {
+        throw std::invalid_argument("Graph is cycled!!");
+    }
+    return order;
+}
+
+// Tarjan's algorithm for strongly connected components
+std::vector<std::vector<int>> SnapshotGraph::Snapshot::TarjansAlgorithm() const
+{
+    return tarjanComponents(*this);
+}
+
+// Labels every vertex with the index of its connected component
+std::vector<int> SnapshotGraph::Snapshot::componentLabels() const
+{
+    return ::componentLabels(*this);
+}
@@ -0,0 +1,224 @@
+#ifndef SNAPSHOT_GRAPH_H
+#define SNAPSHOT_GRAPH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../../common/csr.hpp"
+#include "../../common/epoch.hpp"
+#include "../../common/graph_kernels.hpp"
+
+class Vertex;
+
+// Adjacency graph that keeps answering queries while edges are ingested.
+//
+// Writers append to a delta buffer under a mutex. publish() sorts the delta
+// into a new immutable level and swaps in a version that shares every older
+// level with the previous one. Levels of similar size are merged, and all of
+// them are folded into a new CSR base once they outgrow a quarter of it, so each
+// edge is copied O(log) times in total. The delta is published once it
+// reaches publishThreshold edges, or by a background thread once it is
+// maxDelay old.
+//
+// Readers pin a Snapshot and traverse that version without locks; superseded
+// versions are freed through epoch-based reclamation once no snapshot can
+// still see them.
+//
+// Only part of Vertex is covered. Edges and vertices can be added but not
+// removed, and a Snapshot runs the traversals declared on it; PageRank,
+// levels(), Kosaraju and the path enumerations still need a Vertex. The
+// weighted Graph has no snapshot counterpart, so its queries must not run
+// beside its addEdge().
+class SnapshotGraph
+{
+public:
+    // Arcs of one or more publishes. A level touching few vertices stores
+    // only those rows; one touching many is indexed by vertex like a CSR.
+    struct Level
+    {
+        bool dense = false;
+        std::vector<int> rows;              // sorted vertices with arcs here; empty when dense
+        std::vector<std::size_t> offsets;   // arcs of rows[i], or of vertex i when dense, are targets[offsets[i], offsets[i + 1])
+        std::vector<int> targets;
+        std::vector<std::uint64_t> present;   // bit u set when a sparse level has a row for u
+
+        // Arcs of vertex u in this level
+        std::pair<const int*, const int*> row(int u) const;
+    };
+
+    // Immutable published state: the base rows, then the levels from oldest
+    // to newest; versions share the parts they have in common
+    struct Version
+    {
+        std::uint64_t number;
+        int sizeVertexs;
+        std::shared_ptr<const Csr<int>> base;
+        std::vector<std::shared_ptr<const Level>> levels;
+    };
+
+    // Neighbors of one vertex inside a version, base arcs first and then each
+    // level's, so they come in insertion order
+    class Range
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = int;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const int*;
+            using reference = const int&;
+
+            iterator() = default;
+            iterator(const Version* state, int u) : state(state), u(u) { settle(); }
+
+            const int& operator*() const { return *p; }
+            iterator& operator++() { ++p; settle(); return *this; }
+            iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+            bool operator==(const iterator& other) const { return p == other.p; }
+            bool operator!=(const iterator& other) const { return p != other.p; }
+
+        private:
+            const Version* state = nullptr;
+            int u = 0;
+            std::size_t segment = 0;   // next part to read: 0 is the base, k is levels[k - 1]
+            const int* p = nullptr;
+            const int* last = nullptr;
+
+            // Moves to the next arc, past empty parts; null once all are read
+            void settle();
+        };
+
+        Range(const Version* state, int u) : state(state), u(u) {}
+
+        iterator begin() const { return iterator(state, u); }
+        iterator end() const { return iterator(); }
+        std::size_t size() const;
+
+    private:
+        const Version* state;
+        int u;
+    };
+
+    // Pinned, read-only view of one published version
+    class Snapshot
+    {
+    public:
+        // Number of the pinned version
+        std::uint64_t version() const { return state->number; }
+
+        // Returns the number of vertices
+        int size() const { return state->sizeVertexs; }
+
+        // Returns the adjacency list of vertex u
+        Range neighbors(int u) const { return Range(state, u); }
+
+        // Calls f(v, NoWeight {}) for every neighbor v of u, as the
+        // common/graph_kernels.hpp algorithms expect
+        template <typename F>
+        void forEachNeighbor(int u, F&& f) const
+        {
+            for (int v : neighbors(u)) {
+                f(v, NoWeight {});
+            }
+        }
+
+        // Breadth First Search order from start
+        std::vector<int> BFS(int start) const;
+
+        // Iterative Depth First Search order from start
+        std::vector<int> DFS(int start) const;
+
+        // Returns the shortest path between vertices u and v
+        std::vector<int> getShortPath(int u, int v) const;
+
+        // Counts the number of vertices at a given level in BFS
+        int getCountNthLevel(int start, int level) const;
+
+        // Checks if the undirected graph contains a cycle
+        bool isCycledUndirected() const;
+
+        // Checks if the directed graph contains a cycle
+        bool isCycledDirected() const;
+
+        // Kahn's algorithm for topological sorting; throws std::invalid_argument on a cycle
+        std::vector<int> Kahn() const;
+
+        // Tarjan's algorithm for strongly connected components
+        std::vector<std::vector<int>> TarjansAlgorithm() const;
+
+        // Labels every vertex with the index of its connected component
+        std::vector<int> componentLabels() const;
+
+    private:
+        friend class SnapshotGraph;
+        Snapshot(EpochManager::Guard guard, const Version* state) : guard(std::move(guard)), state(state) {}
+        EpochManager::Guard guard;
+        const Version* state;
+    };
+
+    // Constructor for an empty graph with n vertices
+    explicit SnapshotGraph(int n, std::size_t publishThreshold = 1 << 16,
+                           std::chrono::milliseconds maxDelay = std::chrono::milliseconds(100));
+
+    // Constructor that publishes the current contents of 'graph'
+    explicit SnapshotGraph(const Vertex& graph, std::size_t publishThreshold = 1 << 16,
+                           std::chrono::milliseconds maxDelay = std::chrono::milliseconds(100));
+
+    ~SnapshotGraph();
+    SnapshotGraph(const SnapshotGraph&) = delete;
+    SnapshotGraph& operator=(const SnapshotGraph&) = delete;
+
+    // Adds an undirected edge to the delta
+    void addEdge(int u, int v);
+
+    // Adds a directed edge from u to v to the delta
+    void addDirectedEdge(int u, int v);
+
+    // Adds a new vertex to the delta
+    void addVertex();
+
+    // Publishes the delta as a new version
+    void publish();
+
+    // Pins the latest published version
+    Snapshot pin() const;
+
+    // Number of edges waiting in the delta
+    std::size_t pendingEdges() const;
+
+    // Number of superseded versions not yet freed
+    std::size_t retiredVersions() const { return epochs.pending(); }
+
+private:
+    mutable EpochManager epochs;
+    std::atomic<const Version*> current;
+
+    mutable std::mutex writerMutex;
+    int deltaVertexs;
+    std::vector<std::pair<int, int>> delta;
+    std::size_t publishThreshold;
+    std::chrono::milliseconds maxDelay;
+
+    // Publishes a delta that has waited maxDelay, whether or not more edges come
+    std::chrono::steady_clock::time_point pendingSince;
+    std::condition_variable flushWake;
+    bool stopping;
+    std::thread flusher;
+
+    void append(int u, int v);
+    void changed();
+    bool hasPending() const;
+    void publishLocked();
+    void flushLoop();
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include "triangles.hpp"
+#include "graph.hpp"
+#include "../../common/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const std::size_t grain = 256;
+
+// Counts the common elements of two strictly increasing lists, passing each
+// to onMatch when Emit is set. Blocks of both lists are compared all-pairs by
+// rotating one of them, and the block with the smaller maximum moves on.
+template <bool Emit, typename OnMatch>
+long long intersectSorted(const int* a, std::size_t na, const int* b, std::size_t nb, OnMatch onMatch)
+{
+    std::size_t i = 0;
+    std::size_t j = 0;
+    long long count = 0;
+#if defined(__AVX2__)
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i eq = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; ++r) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+        count += __builtin_popcount(mask);
+        if (Emit) {
+            for (; mask; mask &= mask - 1) {
+                onMatch(a[i + __builtin_ctz(mask)]);
+            }
+        }
+        int amax = a[i + 7];
+        int bmax = b[j + 7];
+        i += amax <= bmax ? 8 : 0;
+        j += bmax <= amax ? 8 : 0;
+    }
+#elif defined(__SSE4_2__)
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 4; ++r) {
+            vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+            eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+        count += __builtin_popcount(mask);
+        if (Emit) {
+            for (; mask; mask &= mask - 1) {
+                onMatch(a[i + __builtin_ctz(mask)]);
+            }
+        }
+        int amax = a[i + 3];
+        int bmax = b[j + 3];
+        i += amax <= bmax ? 4 : 0;
+        j += bmax <= amax ? 4 : 0;
+    }
+#endif
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            ++count;
+            if (Emit) {
+                onMatch(a[i]);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+struct CountOnly
+{
+    void operator()(int, int, int) const {}
+};
+
+} // namespace
+
+// Builds the oriented lists from a snapshot of 'graph'
+TriangleCounter::TriangleCounter(const Vertex& graph, unsigned threads)
+    : threads {threads}
+{
+    const int n = graph.size();
+    if (n > 0) {
+        graph.inNeighbors(0);       // build the in-edge index once, up front
+    }
+    const unsigned workers = workerCount(n, threads, grain);
+    std::vector<std::vector<int>> scratch(workers);
+
+    // Sorted, distinct neighbors of u on either side of an edge, u itself excluded
+    auto undirected = [&](unsigned worker, int u) -> std::vector<int>& {
+        std::vector<int>& adj = scratch[worker];
+        adj.clear();
+        for (int v : graph.neighbors(u)) {
+            adj.push_back(v);
+        }
+        for (int v : graph.inNeighbors(u)) {
+            adj.push_back(v);
+        }
+        std::sort(adj.begin(), adj.end());
+        adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+        adj.erase(std::remove(adj.begin(), adj.end(), u), adj.end());
+        return adj;
+    };
+
+    degree.assign(n, 0);
+    parallelForWorker(0, n, [&](unsigned worker, std::size_t u) {
+        degree[u] = static_cast<int>(undirected(worker, static_cast<int>(u)).size());
+    }, workers, grain);
+
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+    });
+    std::vector<int> rank(n);
+    for (int r = 0; r < n; ++r) {
+        rank[order[r]] = r;
+    }
+
+    // Each edge points at its higher-ranked end, so every forward list has at
+    // most as many entries as its vertex's degree, and no more than sqrt(2m)
+    offsets.assign(static_cast<std::size_t>(n) + 1, 0);
+    std::vector<std::size_t> forwardDegree(n, 0);
+    parallelForWorker(0, n, [&](unsigned worker, std::size_t u) {
+        std::size_t count = 0;
+        for (int v : undirected(worker, static_cast<int>(u))) {
+            count += rank[v] > rank[u];
+        }
+        forwardDegree[rank[u]] = count;
+    }, workers, grain);
+    for (int r = 0; r < n; ++r) {
+        offsets[r + 1] = offsets[r] + forwardDegree[r];
+    }
+    forward.resize(offsets[n]);
+    parallelForWorker(0, n, [&](unsigned worker, std::size_t u) {
+        int* out = forward.data() + offsets[rank[u]];
+        int* first = out;
+        for (int v : undirected(worker, static_cast<int>(u))) {
+            if (rank[v] > rank[u]) {
+                *out++ = rank[v];
+            }
+        }
+        std::sort(first, out);
+    }, workers, grain);
+}
+
+// Runs onTriangle(a, b, c) on ranks a < b < c of every triangle whose lowest rank is u
+template <typename OnTriangle>
+long long TriangleCounter::trianglesAt(int u, OnTriangle onTriangle) const
+{
+    const int* fu = forward.data() + offsets[u];
+    const std::size_t nu = offsets[u + 1] - offsets[u];
+    long long count = 0;
+    for (std::size_t k = 0; k < nu; ++k) {
+        int v = fu[k];
+        // Only ranks past v can close a triangle that v's list also holds
+        const int* fv = forward.data() + offsets[v];
+        const std::size_t nv = offsets[v + 1] - offsets[v];
+        if constexpr (std::is_same<OnTriangle, CountOnly>::value) {
+            count += intersectSorted<false>(fu + k + 1, nu - k - 1, fv, nv, [](int) {});
+        } else {
+            count += intersectSorted<true>(fu + k + 1, nu - k - 1, fv, nv, [&](int w) { onTriangle(u, v, w); });
+        }
+    }
+    return count;
+}
+
+// Total number of triangles
+long long TriangleCounter::count() const
+{
+    const int n = size();
+    const unsigned workers = workerCount(n, threads, grain);
+    std::vector<long long> partial(workers, 0);
+    parallelForWorker(0, n, [&](unsigned worker, std::size_t u) {
+        partial[worker] += trianglesAt(static_cast<int>(u), CountOnly {});
+    }, workers, grain);
+    return std::accumulate(partial.begin(), partial.end(), 0LL);
+}
+
+// Number of triangles through every vertex
+std::vector<long long> TriangleCounter::perVertex() const
+{
+    const int n = size();
+    std::vector<std::atomic<long long>> byRank(n);
+    for (auto& c : byRank) {
+        c.store(0, std::memory_order_relaxed);
+    }
+    parallelFor(0, n, [&](std::size_t u) {
+        long long own = trianglesAt(static_cast<int>(u), [&](int, int v, int w) {
+            byRank[v].fetch_add(1, std::memory_order_relaxed);
+            byRank[w].fetch_add(1, std::memory_order_relaxed);
+        });
+        byRank[u].fetch_add(own, std::memory_order_relaxed);
+    }, threads, grain);
+
+    std::vector<long long> triangles(n);
+    for (int r = 0; r < n; ++r) {
+        triangles[order[r]] = byRank[r].load(std::memory_order_relaxed);
+    }
+    return triangles;
+}
+
+// Local clustering coefficient of every vertex, 0 below degree 2
+std::vector<double> TriangleCounter::clustering() const
+{
+    std::vector<long long> triangles = perVertex();
+    std::vector<double> coefficient(size(), 0.0);
+    for (int v = 0; v < size(); ++v) {
+        double d = degree[v];
+        if (d >= 2) {
+            coefficient[v] = 2.0 * triangles[v] / (d * (d - 1));
+        }
+    }
+    return coefficient;
+}
+
+// Unbiased estimate of count() from 'samples' forward edges drawn uniformly
+double TriangleCounter::estimate(std::size_t samples, unsigned seed) const
+{
+    if (samples == 0 || forward.empty()) {
+        return 0.0;
+    }
+    const unsigned workers = workerCount(samples, threads, 1 << 12);
+    std::vector<long long> partial(workers, 0);
+    parallelFor(0, workers, [&](std::size_t worker) {
+        std::mt19937_64 rng(seed + 0x9E3779B97F4A7C15ull * worker);
+        std::uniform_int_distribution<std::size_t> pick(0, forward.size() - 1);
+        std::size_t quota = samples / workers + (worker < samples % workers);
+        long long found = 0;
+        for (std::size_t s = 0; s < quota; ++s) {
+            std::size_t e = pick(rng);
+            int u = static_cast<int>(std::upper_bound(offsets.begin(), offsets.end(), e) - offsets.begin()) - 1;
+            const int* fu = forward.data() + offsets[u];
+            const std::size_t k = e - offsets[u];
+            const int v = fu[k];
+            found += intersectSorted<false>(fu + k + 1, offsets[u + 1] - e - 1, forward.data() + offsets[v], offsets[v + 1] - offsets[v], [](int) {});
+        }
+        partial[worker] = found;
+    }, workers);
+    long long found = std::accumulate(partial.begin(), partial.end(), 0LL);
+    return static_cast<double>(found) * static_cast<double>(forward.size()) / static_cast<double>(samples);
+}
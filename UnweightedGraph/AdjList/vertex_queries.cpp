@@ -0,0 +1,98 @@
+#include "vertex_queries.hpp"
+#include "graph.hpp"
+#include "reachability.hpp"
+#include <algorithm>
+
+VertexQueries::VertexQueries(const Vertex& graph, const ReachabilityIndex* index)
+    : graph {graph}
+    , index {index}
+{}
+
+// Runs one BFS from the shared source, only as deep as the group needs:
+// until every target is found and the deepest requested level is complete.
+void VertexQueries::run(const std::vector<const Query*>& group, std::vector<Result>& results, Workspace& ws) const
+{
+    const int n = graph.size();
+    const int src = group.front()->source;
+    if (static_cast<int>(ws.dist.size()) != n) {
+        ws.dist.assign(n, -1);
+        ws.parent.assign(n, -1);
+        ws.queue.reserve(n);
+    }
+
+    int maxLevel = -1;
+    int targetsLeft = 0;
+    for (std::size_t k = 0; k < group.size(); ++k) {
+        const Query& q = *group[k];
+        if (q.type == Reachable && index) {
+            results[k].value = index->reachable(q.source, q.arg);
+        } else if (q.type == CountNthLevel) {
+            maxLevel = std::max(maxLevel, q.arg);
+        } else {
+            ++targetsLeft;
+        }
+    }
+    if (maxLevel < 0 && targetsLeft == 0) {
+        return;
+    }
+
+    // Targets are counted once per query, so duplicates are fine
+    std::vector<int> wanted;
+    for (const Query* q : group) {
+        if (q->type == ShortPath || (q->type == Reachable && !index)) {
+            wanted.push_back(q->arg);
+        }
+    }
+    std::sort(wanted.begin(), wanted.end());
+    auto isWanted = [&](int v) { return std::binary_search(wanted.begin(), wanted.end(), v); };
+
+    std::vector<long long> levelCount;
+    ws.queue.clear();
+    ws.queue.push_back(src);
+    ws.dist[src] = 0;
+    std::size_t levelStart = 0;
+    for (int level = 0; levelStart < ws.queue.size(); ++level) {
+        std::size_t levelEnd = ws.queue.size();
+        levelCount.push_back(static_cast<long long>(levelEnd - levelStart));
+        for (std::size_t i = levelStart; i < levelEnd; ++i) {
+            if (isWanted(ws.queue[i])) {
+                targetsLeft -= static_cast<int>(std::count(wanted.begin(), wanted.end(), ws.queue[i]));
+            }
+        }
+        if (targetsLeft <= 0 && level >= maxLevel) {
+            break;
+        }
+        for (std::size_t i = levelStart; i < levelEnd; ++i) {
+            int x = ws.queue[i];
+            for (int y : graph.neighbors(x)) {
+                if (ws.dist[y] == -1) {
+                    ws.dist[y] = level + 1;
+                    ws.parent[y] = x;
+                    ws.queue.push_back(y);
+                }
+            }
+        }
+        levelStart = levelEnd;
+    }
+
+    for (std::size_t k = 0; k < group.size(); ++k) {
+        const Query& q = *group[k];
+        if (q.type == CountNthLevel) {
+            results[k].value = (q.arg >= 0 && q.arg < static_cast<int>(levelCount.size())) ? levelCount[q.arg] : 0;
+        } else if (q.type == Reachable && !index) {
+            results[k].value = ws.dist[q.arg] != -1;
+        } else if (q.type == ShortPath && ws.dist[q.arg] != -1) {
+            for (int v = q.arg; v != src; v = ws.parent[v]) {
+                results[k].path.push_back(v);
+            }
+            results[k].path.push_back(src);
+            std::reverse(results[k].path.begin(), results[k].path.end());
+        }
+    }
+
+    // Reset only what this BFS touched
+    for (int v : ws.queue) {
+        ws.dist[v] = -1;
+        ws.parent[v] = -1;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef VERTEX_QUERIES_H
+#define VERTEX_QUERIES_H
+
+#include <cstdint>
+#include <vector>
+
+class Vertex;
+class ReachabilityIndex;
+
+// QueryEngine backend for Vertex: shortest paths, level counts and
+// reachability. Queries are grouped by source so one BFS answers all of them.
+class VertexQueries
+{
+public:
+    enum Type { ShortPath, CountNthLevel, Reachable, typeCount };
+
+    struct Query
+    {
+        Type type;
+        int source;
+        int arg;        // target vertex, or the level for CountNthLevel
+    };
+
+    struct Result
+    {
+        std::vector<int> path;      // ShortPath: the path, empty when unreachable
+        long long value = 0;        // CountNthLevel: the count; Reachable: 0 or 1
+    };
+
+    // Per-worker BFS buffers, reused across queries
+    struct Workspace
+    {
+        std::vector<int> dist;
+        std::vector<int> parent;
+        std::vector<int> queue;
+    };
+
+    // Reachable queries use 'index' when given, and the shared BFS otherwise
+    explicit VertexQueries(const Vertex& graph, const ReachabilityIndex* index = nullptr);
+
+    static int typeOf(const Query& q) { return q.type; }
+    std::uint64_t groupKey(const Query& q) const { return static_cast<std::uint64_t>(q.source); }
+
+    // Answers a group of queries that share one source
+    void run(const std::vector<const Query*>& group, std::vector<Result>& results, Workspace& ws) const;
+
+private:
+    const Vertex& graph;
+    const ReachabilityIndex* index;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "apsp.hpp"
+#include "graph.hpp"
+#include "../../common/parallel.hpp"
+#include <algorithm>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// c[j] = min(c[j], a + b[j]) over one tile row. An infinite b[j] stays
+// infinite: for integers infinity() is a finite value that a negative 'a'
+// would otherwise pull below the "no path" mark.
+template <typename T>
+inline void minPlusRow(T* c, T a, const T* b)
+{
+    for (int j = 0; j < DistanceMatrix<T>::tileSize; ++j) {
+        T s = a + b[j];
+        if constexpr (!std::numeric_limits<T>::has_infinity) {
+            s = b[j] < DistanceMatrix<T>::infinity() ? s : DistanceMatrix<T>::infinity();
+        }
+        c[j] = s < c[j] ? s : c[j];
+    }
+}
+
+#ifdef __AVX2__
+template <>
+inline void minPlusRow<int>(int* c, int a, const int* b)
+{
+    __m256i va = _mm256_set1_epi32(a);
+    __m256i vinf = _mm256_set1_epi32(DistanceMatrix<int>::infinity());
+    for (int j = 0; j < DistanceMatrix<int>::tileSize; j += 8) {
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + j));
+        __m256i finite = _mm256_cmpgt_epi32(vinf, vb);
+        vc = _mm256_min_epi32(vc, _mm256_blendv_epi8(vinf, _mm256_add_epi32(va, vb), finite));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + j), vc);
+    }
+}
+
+template <>
+inline void minPlusRow<float>(float* c, float a, const float* b)
+{
+    __m256 va = _mm256_set1_ps(a);
+    for (int j = 0; j < DistanceMatrix<float>::tileSize; j += 8) {
+        __m256 vc = _mm256_min_ps(_mm256_loadu_ps(c + j), _mm256_add_ps(va, _mm256_loadu_ps(b + j)));
+        _mm256_storeu_ps(c + j, vc);
+    }
+}
+
+template <>
+inline void minPlusRow<double>(double* c, double a, const double* b)
+{
+    __m256d va = _mm256_set1_pd(a);
+    for (int j = 0; j < DistanceMatrix<double>::tileSize; j += 4) {
+        __m256d vc = _mm256_min_pd(_mm256_loadu_pd(c + j), _mm256_add_pd(va, _mm256_loadu_pd(b + j)));
+        _mm256_storeu_pd(c + j, vc);
+    }
+}
+#endif
+
+} // namespace
+
+// Constructor: every distance is infinity except the diagonal
+template <typename T>
+DistanceMatrix<T>::DistanceMatrix(int n)
+    : n(n)
+    , stride((n + tileSize - 1) / tileSize * tileSize)
+    , data(std::size_t(stride) * stride, infinity())
+{
+    for (int i = 0; i < n; ++i) {
+        data[std::size_t(i) * stride + i] = 0;
+    }
+}
+
+// Sets the length of the edge i -> j, keeping the shorter one on duplicates
+template <typename T>
+void DistanceMatrix<T>::setEdge(int i, int j, T weight)
+{
+    T& d = data[std::size_t(i) * stride + j];
+    d = std::min(d, weight);
+}
+
+// Relaxes tile (ti, tj) through the vertices of tile column tk.
+// k is the outermost loop, so this is also correct when the tiles alias.
+template <typename T>
+void DistanceMatrix<T>::updateTile(int ti, int tj, int tk)
+{
+    const int i0 = ti * tileSize, j0 = tj * tileSize, k0 = tk * tileSize;
+    for (int k = k0; k < k0 + tileSize; ++k) {
+        const T* rk = row(k) + j0;
+        for (int i = i0; i < i0 + tileSize; ++i) {
+            T* ri = row(i);
+            T a = ri[k];
+            if (a < infinity()) {
+                minPlusRow(ri + j0, a, rk);
+            }
+        }
+    }
+}
+
+// Tiled Floyd-Warshall: for each diagonal tile, close the tile itself, then its
+// row and column of tiles, then every remaining tile. Each phase is spread
+// across threads since its tiles are independent.
+template <typename T>
+void DistanceMatrix<T>::solve(unsigned threads)
+{
+    const int tiles = stride / tileSize;
+    for (int k = 0; k < tiles; ++k) {
+        updateTile(k, k, k);
+
+        parallelFor(0, std::size_t(tiles) * 2, [&](std::size_t t) {
+            int other = static_cast<int>(t / 2);
+            if (other == k) {
+                return;
+            }
+            if (t % 2 == 0) {
+                updateTile(k, other, k);
+            } else {
+                updateTile(other, k, k);
+            }
+        }, threads);
+
+        parallelFor(0, std::size_t(tiles) * tiles, [&](std::size_t t) {
+            int i = static_cast<int>(t / tiles), j = static_cast<int>(t % tiles);
+            if (i != k && j != k) {
+                updateTile(i, j, k);
+            }
+        }, threads);
+    }
+}
+
+// Hop-count distances between all pairs of vertices of the matrix graph
+DistanceMatrix<int> allPairsHops(const Graph& graph, unsigned threads)
+{
+    DistanceMatrix<int> dist(graph.size());
+    for (int i = 0; i < graph.size(); ++i) {
+        for (int j = 0; j < graph.size(); ++j) {
+            if (i != j && graph.hasEdge(i, j)) {
+                dist.setEdge(i, j, 1);
+            }
+        }
+    }
+    dist.solve(threads);
+    return dist;
+}
+
+template class DistanceMatrix<int>;
+template class DistanceMatrix<float>;
+template class DistanceMatrix<double>;
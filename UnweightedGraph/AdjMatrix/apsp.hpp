@@ -0,0 +1,57 @@
+#ifndef APSP_H
+#define APSP_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+class Graph;
+
+// Dense row-major distance matrix for all-pairs shortest paths.
+// Rows are padded to a multiple of the tile size so the blocked
+// Floyd-Warshall never has to handle partial tiles.
+template <typename T>
+class DistanceMatrix
+{
+public:
+    // Edge length of the square tiles the solver works on
+    static constexpr int tileSize = 64;
+
+    // Constructor: every distance is infinity except the diagonal
+    explicit DistanceMatrix(int n);
+
+    // Value used for "no path"; sums of two infinities never overflow
+    static constexpr T infinity()
+    {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max() / 2;
+    }
+
+    // Number of vertices
+    int size() const { return n; }
+
+    // Distance from i to j
+    T at(int i, int j) const { return data[std::size_t(i) * stride + j]; }
+
+    // Checks whether j is reachable from i
+    bool reachable(int i, int j) const { return at(i, j) < infinity(); }
+
+    // Sets the length of the edge i -> j, keeping the shorter one on duplicates
+    void setEdge(int i, int j, T weight);
+
+    // Runs the tiled, multithreaded Floyd-Warshall in place
+    void solve(unsigned threads = 0);
+
+private:
+    int n;
+    int stride;
+    std::vector<T> data;
+
+    T* row(int i) { return data.data() + std::size_t(i) * stride; }
+    void updateTile(int ti, int tj, int tk);
+};
+
+// Hop-count distances between all pairs of vertices of the matrix graph
+DistanceMatrix<int> allPairsHops(const Graph& graph, unsigned threads = 0);
+
+#endif
@@ -0,0 +1,102 @@
+#include "closure.hpp"
+#include "graph.hpp"
+#include "../../common/parallel.hpp"
+#include <algorithm>
+
+namespace {
+
+// Calls f(index) for every set bit of a word-packed row
+template <typename F>
+void forEachBit(const std::uint64_t* row, int words, F f)
+{
+    for (int w = 0; w < words; ++w) {
+        std::uint64_t x = row[w];
+        while (x) {
+            f(w * 64 + __builtin_ctzll(x));
+            x &= x - 1;
+        }
+    }
+}
+
+} // namespace
+
+// Returns every vertex reachable from u, in increasing order
+std::vector<int> ReachabilityMatrix::reachableFrom(int u) const
+{
+    std::vector<int> res;
+    for (int v = 0; v < size(); ++v) {
+        if (reachable(u, v)) {
+            res.push_back(v);
+        }
+    }
+    return res;
+}
+
+// Tarjan emits a component only after every component it reaches, so edges of
+// the condensation always go from a higher component id to a lower one. Rows are
+// final once all lower components are, which lets each height level of the
+// condensation DAG be closed in parallel with word-wide ORs.
+ReachabilityMatrix transitiveClosure(const Graph& graph, unsigned threads)
+{
+    ReachabilityMatrix res;
+    const int n = graph.size();
+    std::vector<std::vector<int>> SCCs = graph.TarjansAlgorithm();
+    const int C = static_cast<int>(SCCs.size());
+    const int words = (C + 63) / 64;
+    res.components = C;
+    res.words = words;
+    res.component.assign(n, -1);
+    for (int c = 0; c < C; ++c) {
+        for (int v : SCCs[c]) {
+            res.component[v] = c;
+        }
+    }
+
+    // Direct successors of each component, plus the component itself
+    std::vector<std::uint64_t> direct(std::size_t(C) * words, 0);
+    parallelFor(0, C, [&](std::size_t c) {
+        std::uint64_t* row = &direct[c * words];
+        row[c / 64] |= std::uint64_t(1) << (c % 64);
+        for (int u : SCCs[c]) {
+            for (int v = 0; v < n; ++v) {
+                if (graph.hasEdge(u, v) && res.component[v] >= 0) {
+                    int d = res.component[v];
+                    row[d / 64] |= std::uint64_t(1) << (d % 64);
+                }
+            }
+        }
+    }, threads, 16);
+
+    // Height of each component above the sinks of the condensation
+    std::vector<int> height(C, 0);
+    int maxHeight = 0;
+    for (int c = 0; c < C; ++c) {
+        forEachBit(&direct[std::size_t(c) * words], words, [&](int d) {
+            if (d != c) {
+                height[c] = std::max(height[c], height[d] + 1);
+            }
+        });
+        maxHeight = std::max(maxHeight, height[c]);
+    }
+    std::vector<std::vector<int>> levels(maxHeight + 1);
+    for (int c = 0; c < C; ++c) {
+        levels[height[c]].push_back(c);
+    }
+
+    res.bits = direct;
+    for (const auto& level : levels) {
+        parallelFor(0, level.size(), [&](std::size_t k) {
+            int c = level[k];
+            std::uint64_t* row = &res.bits[std::size_t(c) * words];
+            forEachBit(&direct[std::size_t(c) * words], words, [&](int d) {
+                if (d != c) {
+                    const std::uint64_t* src = &res.bits[std::size_t(d) * words];
+                    for (int w = 0; w < words; ++w) {
+                        row[w] |= src[w];
+                    }
+                }
+            });
+        }, threads, 8);
+    }
+    return res;
+}
@@ -0,0 +1,50 @@
+#ifndef CLOSURE_H
+#define CLOSURE_H
+
+#include <cstdint>
+#include <vector>
+
+class Graph;
+
+// Transitive closure of a directed graph stored per strongly connected
+// component: one bit row per component, 64 components per word.
+class ReachabilityMatrix
+{
+public:
+    // Number of vertices
+    int size() const { return static_cast<int>(component.size()); }
+
+    // Number of strongly connected components
+    int componentCount() const { return components; }
+
+    // Component id of vertex 'v', -1 for a removed vertex
+    int componentOf(int v) const { return component[v]; }
+
+    // Checks whether 'v' can be reached from 'u' (every live vertex reaches
+    // itself); false when either one is removed
+    bool reachable(int u, int v) const
+    {
+        int cu = component[u], cv = component[v];
+        if (cu < 0 || cv < 0) {
+            return false;
+        }
+        return (bits[std::size_t(cu) * words + cv / 64] >> (cv % 64)) & 1;
+    }
+
+    // Returns every vertex reachable from 'u', in increasing order
+    std::vector<int> reachableFrom(int u) const;
+
+private:
+    friend ReachabilityMatrix transitiveClosure(const Graph& graph, unsigned threads);
+
+    int components = 0;
+    int words = 0;
+    std::vector<int> component;
+    std::vector<std::uint64_t> bits;
+};
+
+// Builds the closure: contracts SCCs, then ORs successor rows of the
+// condensation level by level, with each level split across threads
+ReachabilityMatrix transitiveClosure(const Graph& graph, unsigned threads = 0);
+
+#endif
@@ -15,9 +15,30 @@ public:
     // Adds an edge between vertex 'u' and vertex 'v'
     void addEdge(int u, int v);
 
+    // Adds a directed edge from vertex 'u' to vertex 'v'
+    void addDirectedEdge(int u, int v);
+
     // Adds a new vertex to the graph
     void addVetex();
 
+    // Removes the edge between vertex 'u' and vertex 'v'; returns false when there is none
+    bool removeEdge(int u, int v);
+
+    // Removes the directed edge from vertex 'u' to vertex 'v'; returns false when there is none
+    bool removeDirectedEdge(int u, int v);
+
+    // Removes vertex 'v' and its edges without reshaping the matrix
+    void removeVertex(int v);
+
+    // Checks whether vertex 'v' has been removed
+    bool isRemoved(int v) const;
+
+    // Returns the number of vertices
+    int size() const;
+
+    // Checks whether there is an edge from vertex 'u' to vertex 'v'
+    bool hasEdge(int u, int v) const;
+
     // Performs an iterative Depth First Search (DFS) starting from 'start' vertex
     void DFS(int start) const;
 
@@ -67,29 +88,11 @@ private:
     // Adjacency matrix to represent the graph
     std::vector<std::vector<int>> adjMatrix;
 
-    // Helper function for Depth First Search (DFS)
-    void dfsHelper(int src, std::vector<int>& visit) const;
-
-    // Helper function for detecting a cycle in an undirected graph
-    bool dfsCycledUndirected(int src, std::vector<bool>& visit, int perent) const;
-
-    // Helper function for detecting a cycle in a directed graph
-    bool dfsCycledDirected(int start, std::vector<bool>& visit, std::vector<bool>& onStack) const;
-
-    // Helper function for topological sorting using DFS
-    void dfsTopSort(int src, std::vector<bool>& visit, std::stack<int>& st) const;
-
-    // Helper function for finding all paths from 'src' to 'dest'
-    void dfsAllPaths(int src, int dest, std::vector<int>& tmp, std::vector<std::vector<int>>& res, std::vector<bool>& visit) const;
-
-    // Helper function to fill vertices in order of their finishing times (Kosarajou's algorithm)
-    void fillinorder(int src, std::vector<bool>& visit, std::stack<int>& st) const;
-
-    // Helper function to perform DFS in Kosarajou's algorithm
-    void dfsKosarajou(int src, std::vector<bool>& visit, std::vector<int>& vec) const;
+    // Removed vertices keep their slot, with an empty row and column
+    std::vector<bool> removed;
 
-    // Helper function for Tarjan's algorithm to find SCCs
-    void TarjanHelper(int src, std::vector<int>& ids, std::vector<int>& lowlink, std::stack<int>& st, std::vector<bool>& onStack, std::vector<std::vector<int>>& SCCs) const;
+    // The matrix rows as a graph for the common/graph_kernels.hpp algorithms; defined in graph.cpp
+    auto outGraph() const;
 };
 
 #endif
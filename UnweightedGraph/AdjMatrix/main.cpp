@@ -1,5 +1,7 @@
 #include <iostream>
 #include "graph.hpp"
+#include "apsp.hpp"
+#include "closure.hpp"
 
 int main() {
     // Create a graph with 5 vertices
@@ -42,6 +44,28 @@ int main() {
     std::cout << "Transposed Graph Adjacency Matrix:" << std::endl;
     graph.print();
 
+    // All-pairs hop counts with the blocked Floyd-Warshall
+    DistanceMatrix<int> hops = allPairsHops(graph);
+    std::cout << "All-pairs hop counts:" << std::endl;
+    for (int i = 0; i < hops.size(); ++i) {
+        for (int j = 0; j < hops.size(); ++j) {
+            if (hops.reachable(i, j)) {
+                std::cout << hops.at(i, j) << " ";
+            } else {
+                std::cout << "- ";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    // Reachability table from the transitive closure
+    ReachabilityMatrix closure = transitiveClosure(graph);
+    std::cout << "Vertices reachable from 0: ";
+    for (int vertex : closure.reachableFrom(0)) {
+        std::cout << vertex << " ";
+    }
+    std::cout << std::endl;
+
     // Check for cycles in the undirected graph
     std::cout << "Cycle Detected in Undirected Graph: " << (graph.isCycledUndirected() ? "Yes" : "No") << std::endl;
 
@@ -0,0 +1,86 @@
+// Compares Vertex adjacency storage on the default allocator against
+// EdgeArena: build time, resident memory and destruction time.
+//
+//   g++ -std=c++17 -O2 -I../UnweightedGraph/AdjList arena_bench.cpp ../UnweightedGraph/AdjList/graph.cpp
+//   ./arena_bench [vertices] [edges]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../common/edge_arena.hpp"
+#include "graph.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Resident set size in MiB, from /proc/self/statm
+double residentMiB()
+{
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0;
+    long resident = 0;
+    statm >> pages >> resident;
+    return double(resident) * double(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+void run(const char* label, int n, long long m, std::pmr::memory_resource* resource, EdgeArena* arena)
+{
+    double before = residentMiB();
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+
+    auto start = Clock::now();
+    auto graph = std::make_unique<Vertex>(n, resource);
+    for (long long i = 0; i < m; ++i) {
+        graph->addDirectedEdge(pick(rng), pick(rng));
+    }
+    double build = secondsSince(start);
+    double rss = residentMiB() - before;
+
+    start = Clock::now();
+    graph.reset();
+    if (arena) {
+        arena->release();
+    }
+    double destroy = secondsSince(start);
+
+    std::printf("%-8s build %.3fs  rss +%.1f MiB  destroy %.3fs\n", label, build, rss, destroy);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    long long m = argc > 2 ? std::atoll(argv[2]) : 8000000;
+    std::cout << n << " vertices, " << m << " directed edges\n";
+
+    // Each layout runs in its own process so RSS starts from the same baseline
+    for (int layout = 0; layout < 2; ++layout) {
+        std::cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            if (layout == 0) {
+                run("default", n, m, std::pmr::new_delete_resource(), nullptr);
+            } else {
+                EdgeArena arena;
+                run("arena", n, m, &arena, &arena);
+            }
+            std::fflush(stdout);
+            _exit(0);
+        }
+        waitpid(child, nullptr, 0);
+    }
+}
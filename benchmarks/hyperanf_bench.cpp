@@ -0,0 +1,76 @@
+// Compares HyperANF ball-size estimates with exact counts from one BFS per
+// vertex: run time, and mean and worst relative error at every hop.
+//
+//   g++ -std=c++17 -O2 -pthread -I../UnweightedGraph/AdjList hyperanf_bench.cpp ../UnweightedGraph/AdjList/graph.cpp
+//   ./hyperanf_bench [vertices] [edges] [hops]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../common/hyperanf.hpp"
+#include "graph.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 20000;
+    long long m = argc > 2 ? std::atoll(argv[2]) : 60000;
+    int hops = argc > 3 ? std::atoi(argv[3]) : 6;
+    std::printf("%d vertices, %lld directed edges, %d hops\n", n, m, hops);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    Vertex graph(n);
+    for (long long i = 0; i < m; ++i) {
+        graph.addDirectedEdge(pick(rng), pick(rng));
+    }
+
+    // exact[t][v]: vertices within t hops of v
+    auto start = Clock::now();
+    std::vector<std::vector<double>> exact(hops + 1, std::vector<double>(n, 0.0));
+    for (int v = 0; v < n; ++v) {
+        for (int d : graph.levels(v)) {
+            if (d >= 0 && d <= hops) {
+                for (int t = d; t <= hops; ++t) {
+                    ++exact[t][v];
+                }
+            }
+        }
+    }
+    std::printf("exact BFS        %.3fs\n", secondsSince(start));
+
+    for (int precision : {4, 6, 8, 10}) {
+        HyperAnfOptions options;
+        options.precision = precision;
+        start = Clock::now();
+        NeighborhoodFunction nf = hyperAnf(graph, hops, options);
+        double seconds = secondsSince(start);
+        std::printf("hyperanf p=%-2d    %.3fs  %4d B/vertex  error mean/max by hop:", precision, seconds, 2 << precision);
+        for (int t = 1; t <= hops; ++t) {
+            const std::vector<double>& ball = nf.balls[std::min<std::size_t>(t, nf.balls.size() - 1)];
+            double sum = 0;
+            double worst = 0;
+            for (int v = 0; v < n; ++v) {
+                double err = std::fabs(ball[v] - exact[t][v]) / exact[t][v];
+                sum += err;
+                worst = std::max(worst, err);
+            }
+            std::printf(" %.3f/%.2f", sum / n, worst);
+        }
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,122 @@
+// Runs parallel PageRank and HyperANF under different memory policies: NUMA
+// placement of the adjacency and per-vertex arrays, huge pages and worker
+// pinning. Without a policy argument it compares the default policy with the
+// one set by GRAPH_NUMA / GRAPH_HUGEPAGES / GRAPH_PIN; "all" sweeps every
+// combination.
+//
+//   g++ -std=c++17 -O2 -pthread -I../UnweightedGraph/AdjList memory_bench.cpp ../UnweightedGraph/AdjList/graph.cpp
+//   GRAPH_NUMA=interleave GRAPH_HUGEPAGES=transparent ./memory_bench [vertices] [edges] [all]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../common/edge_arena.hpp"
+#include "../common/hyperanf.hpp"
+#include "../common/memory_policy.hpp"
+#include "graph.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Anonymous memory currently backed by transparent huge pages, in MiB
+double transparentHugeMiB()
+{
+    std::ifstream rollup("/proc/self/smaps_rollup");
+    std::string key;
+    double kb = 0;
+    while (rollup >> key) {
+        if (key == "AnonHugePages:") {
+            rollup >> kb;
+            break;
+        }
+    }
+    return kb / 1024.0;
+}
+
+std::string describe(const MemoryPolicy& policy)
+{
+    const char* placement[] = {"local", "interleave", "partition"};
+    const char* pages[] = {"off", "transparent", "explicit"};
+    return std::string(placement[static_cast<int>(policy.placement)]) + "/" + pages[static_cast<int>(policy.hugePages)]
+        + (policy.pinThreads ? "/pinned" : "");
+}
+
+void run(const MemoryPolicy& policy, int n, long long m)
+{
+    MemoryPolicy::setActive(policy);
+    PolicyResource resource(policy);
+    EdgeArena arena(std::size_t(2) << 20, &resource);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    auto start = Clock::now();
+    Vertex graph(n, &arena);
+    for (long long i = 0; i < m; ++i) {
+        graph.addDirectedEdge(pick(rng), pick(rng));
+    }
+    double build = secondsSince(start);
+
+    PageRankOptions options;
+    options.tolerance = 0;
+    options.maxIterations = 20;
+    graph.pageRank(options);        // builds the in-edge index outside the timing
+    start = Clock::now();
+    graph.pageRank(options);
+    double pagerank = secondsSince(start);
+    double huge = transparentHugeMiB();
+
+    HyperAnfOptions anf;
+    anf.precision = 6;
+    start = Clock::now();
+    hyperAnf(graph, 4, anf);
+    double hyperanf = secondsSince(start);
+
+    PolicyResource::Stats arenaStats = resource.stats();
+    PolicyResource::Stats arrayStats = PolicyResource::shared().stats();
+    std::printf("%-28s build %6.3fs  pagerank x20 %6.3fs  hyperanf x4 %6.3fs  THP %7.1f MiB  hugetlb %5zu MiB  fallbacks %zu  mbind failures %zu\n",
+                describe(policy).c_str(), build, pagerank, hyperanf, huge,
+                (arenaStats.hugetlbBytes + arrayStats.hugetlbBytes) >> 20,
+                arenaStats.hugetlbFallbacks + arrayStats.hugetlbFallbacks,
+                arenaStats.placementFailures + arrayStats.placementFailures);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    long long m = argc > 2 ? std::atoll(argv[2]) : 8000000;
+    bool sweep = argc > 3 && std::strcmp(argv[3], "all") == 0;
+    const NumaTopology& topology = NumaTopology::get();
+    std::printf("%d vertices, %lld directed edges, %zu NUMA node(s), %zu usable CPU(s)\n",
+                n, m, topology.nodes.size(), topology.allCpus().size());
+
+    std::vector<MemoryPolicy> policies {MemoryPolicy {}};
+    if (sweep) {
+        for (NumaPlacement placement : {NumaPlacement::local, NumaPlacement::interleave, NumaPlacement::partition}) {
+            for (HugePages pages : {HugePages::off, HugePages::transparent, HugePages::explicit_}) {
+                for (bool pin : {false, true}) {
+                    if (placement != NumaPlacement::local || pages != HugePages::off || pin) {
+                        policies.push_back(MemoryPolicy {placement, pages, pin});
+                    }
+                }
+            }
+        }
+    } else {
+        policies.push_back(MemoryPolicy::fromEnvironment());
+    }
+    for (const MemoryPolicy& policy : policies) {
+        run(policy, n, m);
+    }
+}
@@ -0,0 +1,114 @@
+// Compares distributedLevels() and distributedComponents() on 1 to 4 rank
+// processes with Vertex::levels() and a union-find on random graphs, cut by
+// both partitions. The ranks are forked first, and PageRank runs its worker
+// threads between the distributed calls, as a program mixing both would.
+// Exits non-zero on the first mismatch.
+//
+//   g++ -std=c++17 -O2 -pthread -I../UnweightedGraph/AdjList distributed_check.cpp ../UnweightedGraph/AdjList/graph.cpp ../UnweightedGraph/AdjList/distributed.cpp
+//   ./distributed_check [graphs]
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "distributed.hpp"
+#include "graph.hpp"
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* what, int graph)
+{
+    if (!condition) {
+        std::printf("graph %d: %s\n", graph, what);
+        ++failures;
+    }
+}
+
+// Smallest vertex id of every weakly connected component
+std::vector<int> referenceComponents(const Vertex& graph)
+{
+    const int n = graph.size();
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int v) {
+        while (parent[v] != v) {
+            v = parent[v] = parent[parent[v]];
+        }
+        return v;
+    };
+    for (int u = 0; u < n; ++u) {
+        for (int v : graph.neighbors(u)) {
+            int a = find(u), b = find(v);
+            if (a != b) {
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+    std::vector<int> label(n);
+    for (int v = 0; v < n; ++v) {
+        label[v] = find(v);
+    }
+    return label;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const int graphs = argc > 1 ? std::atoi(argv[1]) : 200;
+    std::vector<std::unique_ptr<DistributedProcesses>> groups;
+    for (int processes = 1; processes <= 4; ++processes) {
+        groups.push_back(std::make_unique<DistributedProcesses>(processes));
+    }
+
+    PageRankOptions threaded;
+    threaded.threads = 3;
+    std::mt19937 rng(1);
+    for (int id = 0; id < graphs; ++id) {
+        const int n = 1 + static_cast<int>(rng() % 60);
+        Vertex graph(n);
+        for (int i = 0, m = static_cast<int>(rng() % (2 * n + 1)); i < m; ++i) {
+            graph.addDirectedEdge(rng() % n, rng() % n);
+        }
+        if (id % 5 == 0) {
+            graph.removeVertex(rng() % n);
+        }
+        graph.pageRank(threaded);
+
+        DistributedProcesses& processes = *groups[id % groups.size()];
+        const Partition partitions[] = {Partition::blocks(n, processes.size()),
+                                        Partition::edgeBalanced(graph, processes.size())};
+        const int start = static_cast<int>(rng() % n);
+        const std::vector<int> levels = graph.levels(start);
+        const std::vector<int> components = referenceComponents(graph);
+        for (const Partition& partition : partitions) {
+            expect(distributedLevels(processes, graph, start, partition) == levels, "levels differ", id);
+            expect(distributedComponents(processes, graph, partition) == components, "components differ", id);
+        }
+    }
+
+    // A rejected call leaves the ranks usable
+    Vertex path(3);
+    path.addDirectedEdge(0, 1);
+    path.addDirectedEdge(1, 2);
+    bool threw = false;
+    try {
+        distributedLevels(*groups[2], path, 3, Partition::blocks(3, 3));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    expect(threw, "invalid start accepted", -1);
+    expect(distributedLevels(*groups[2], path, 0, Partition::blocks(3, 3)) == std::vector<int> {0, 1, 2},
+           "levels differ after a rejected call", -1);
+
+    if (failures != 0) {
+        std::printf("%d failures\n", failures);
+        return 1;
+    }
+    std::printf("%d graphs ok\n", graphs);
+}
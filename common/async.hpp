@@ -0,0 +1,234 @@
+#ifndef ASYNC_H
+#define ASYNC_H
+
+// Coroutine support for long-running graph algorithms. Requires C++20.
+//
+// An algorithm written as a coroutine returns a Task<T>. Executor::start()
+// schedules it on the executor's threads. The body calls ctx.tick() as it
+// scans edges and co_awaits ctx.yield() whenever tick() says so; that
+// re-queues the coroutine behind other work, publishes progress and throws
+// OperationCancelled once stop has been requested on ctx.stop.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+#include "thread_pool.hpp"
+
+// Thrown inside a cancelled coroutine and rethrown by Task::get()
+class OperationCancelled : public std::runtime_error
+{
+public:
+    OperationCancelled() : std::runtime_error("Operation cancelled!!") {}
+};
+
+// Small executor that resumes coroutines on a work-stealing pool
+class Executor
+{
+public:
+    explicit Executor(unsigned threads = 1) : pool(threads) {}
+
+    // Resumes 'h' on one of the executor's threads
+    void post(std::coroutine_handle<> h)
+    {
+        pool.submit([h](unsigned) { h.resume(); });
+    }
+
+    // Schedules a task that has not started yet
+    template <typename TaskT>
+    void start(TaskT& task)
+    {
+        task.started = true;
+        post(task.handle);
+    }
+
+private:
+    WorkStealingPool pool;
+};
+
+// Progress of one running algorithm, readable from any thread
+struct Progress
+{
+    std::atomic<std::uint64_t> done {0};
+    std::atomic<std::uint64_t> total {0};
+
+    // Fraction of the work completed, in [0, 1]
+    double fraction() const
+    {
+        std::uint64_t t = total.load();
+        return t == 0 ? 0.0 : std::min(1.0, double(done.load()) / double(t));
+    }
+};
+
+// Everything an async algorithm needs to yield, report and stop
+struct AsyncContext
+{
+    Executor* executor;
+    std::stop_token stop;
+    std::shared_ptr<Progress> progress = std::make_shared<Progress>();
+    std::uint64_t yieldEvery = 1 << 16;
+    std::uint64_t sinceYield = 0;
+
+    // Counts 'edges' units of work; true when it is time to co_await yield()
+    bool tick(std::uint64_t edges = 1)
+    {
+        sinceYield += edges;
+        return sinceYield >= yieldEvery;
+    }
+
+    // Awaitable that publishes progress, requeues the coroutine and checks for stop
+    auto yield()
+    {
+        struct Awaiter
+        {
+            AsyncContext& ctx;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ctx.executor->post(h); }
+            void await_resume()
+            {
+                if (ctx.stop.stop_requested()) {
+                    throw OperationCancelled();
+                }
+            }
+        };
+        progress->done.fetch_add(sinceYield);
+        sinceYield = 0;
+        return Awaiter {*this};
+    }
+
+    // Publishes the remaining work count at the end of a run
+    void finish()
+    {
+        progress->done.fetch_add(sinceYield);
+        sinceYield = 0;
+    }
+};
+
+// Lazily started coroutine producing a T.
+// The Task must outlive the run; its destructor waits for a started run to end.
+template <typename T>
+class Task
+{
+    // Completion state shared by the coroutine frame and the Task, so the
+    // final step can still signal after a waiter has destroyed the frame
+    struct State
+    {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+        std::function<void()> onDone;
+    };
+
+public:
+    struct promise_type
+    {
+        std::shared_ptr<State> state = std::make_shared<State>();
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept
+        {
+            struct Awaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                {
+                    std::shared_ptr<State> s = h.promise().state;
+                    std::function<void()> callback;
+                    {
+                        std::lock_guard<std::mutex> lock(s->mutex);
+                        s->finished = true;
+                        callback = std::move(s->onDone);
+                        s->cv.notify_all();
+                    }
+                    if (callback) {
+                        callback();
+                    }
+                }
+                void await_resume() const noexcept {}
+            };
+            return Awaiter {};
+        }
+
+        void return_value(T v) { state->value = std::move(v); }
+        void unhandled_exception() { state->error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr))
+        , state(std::move(other.state))
+        , started(other.started)
+    {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        if (handle) {
+            if (started) {
+                wait();
+            }
+            handle.destroy();
+        }
+    }
+
+    // Checks whether the coroutine has run to completion
+    bool done() const
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->finished;
+    }
+
+    // Blocks until the coroutine completes
+    void wait() const
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&] { return state->finished; });
+    }
+
+    // Waits and returns the result, rethrowing any exception from the coroutine
+    T get()
+    {
+        wait();
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+        return std::move(*state->value);
+    }
+
+    // Calls 'callback' on completion, from the executor thread that finishes
+    // the task, or right away if it has already finished
+    void onDone(std::function<void()> callback)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->finished) {
+                state->onDone = std::move(callback);
+                return;
+            }
+        }
+        callback();
+    }
+
+private:
+    friend class Executor;
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h), state(h.promise().state) {}
+
+    std::coroutine_handle<promise_type> handle;
+    std::shared_ptr<State> state;
+    bool started = false;
+};
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+#include "csr.hpp"
+
+// 64-bit checksum over a byte stream, in four interleaved lanes of
+// multiply-rotate rounds so the multiplies pipeline. The result does not
+// depend on how the stream is split into update() calls.
+class Checksum
+{
+public:
+    void update(const void* data, std::size_t bytes)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        total += bytes;
+        while (bytes > 0 && filled > 0) {
+            partial[filled++] = *p++;
+            --bytes;
+            if (filled == 8) {
+                consume(partial);
+                filled = 0;
+            }
+        }
+        for (; bytes >= 32; p += 32, bytes -= 32) {
+            consume(p);
+            consume(p + 8);
+            consume(p + 16);
+            consume(p + 24);
+        }
+        for (; bytes >= 8; p += 8, bytes -= 8) {
+            consume(p);
+        }
+        while (bytes > 0) {
+            partial[filled++] = *p++;
+            --bytes;
+        }
+    }
+
+    std::uint64_t value() const
+    {
+        std::uint64_t h = rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18);
+        h ^= total * prime2;
+        for (std::size_t i = 0; i < filled; ++i) {
+            h = rotate(h ^ (partial[i] * prime3), 11) * prime1;
+        }
+        h ^= h >> 33;
+        h *= prime2;
+        h ^= h >> 29;
+        h *= prime3;
+        return h ^ (h >> 32);
+    }
+
+private:
+    static constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+    static constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr std::uint64_t prime3 = 0x165667B19E3779F9ull;
+
+    std::uint64_t lanes[4] = {prime1 + prime2, prime2, 0, 0 - prime1};
+    unsigned next = 0;
+    std::uint64_t total = 0;
+    unsigned char partial[8] = {};
+    std::size_t filled = 0;
+
+    static std::uint64_t rotate(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    void consume(const unsigned char* p)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        std::uint64_t& lane = lanes[next];
+        lane = rotate(lane + word * prime2, 31) * prime1;
+        next = (next + 1) & 3;
+    }
+};
+
+// Snapshot layout: a header {magic, format version, kind}, the payload, then a
+// trailer {payload bytes, checksum of the payload}. Vectors are a 64-bit
+// element count followed by the raw elements, so both sides move them with
+// one large read or write each. Values keep the native byte order and word
+// size: a snapshot is meant to be restored on the machine that wrote it.
+namespace checkpoint_detail {
+
+const std::uint32_t magic = 0x4B435247;     // "GRCK"
+const std::uint32_t formatVersion = 2;     // 2: weighted rows store targets and encoded weights apart
+const std::uint64_t maxElements = std::uint64_t(1) << 40;
+
+// Graph class a snapshot belongs to
+enum Kind : std::uint32_t
+{
+    unweightedGraph = 1,
+    weightedGraph = 2,
+};
+
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t kind;
+    std::uint32_t reserved;
+};
+
+struct Trailer
+{
+    std::uint64_t bytes;
+    std::uint64_t checksum;
+};
+
+} // namespace checkpoint_detail
+
+class CheckpointWriter
+{
+public:
+    // 'kind' names the class the snapshot belongs to
+    CheckpointWriter(std::ostream& os, std::uint32_t kind) : os(os)
+    {
+        checkpoint_detail::Header header {checkpoint_detail::magic, checkpoint_detail::formatVersion, kind, 0};
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    // Writes one plain-data value
+    template <typename T>
+    void put(const T& value) { raw(&value, sizeof(T)); }
+
+    // Writes the element count that starts a vector
+    void beginVector(std::uint64_t count) { put(count); }
+
+    // Writes elements of a vector opened by beginVector()
+    template <typename T>
+    void putElements(const T* data, std::size_t count) { raw(data, count * sizeof(T)); }
+
+    template <typename T>
+    void putVector(const std::vector<T>& vec)
+    {
+        beginVector(vec.size());
+        putElements(vec.data(), vec.size());
+    }
+
+    // Writes the trailer; throws when the stream failed
+    void finish()
+    {
+        checkpoint_detail::Trailer trailer {bytes, sum.value()};
+        os.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+        os.flush();
+        if (!os) {
+            throw std::runtime_error("Cannot write checkpoint!!");
+        }
+    }
+
+private:
+    std::ostream& os;
+    Checksum sum;
+    std::uint64_t bytes = 0;
+
+    void raw(const void* data, std::size_t count)
+    {
+        os.write(static_cast<const char*>(data), static_cast<std::streamsize>(count));
+        sum.update(data, count);
+        bytes += count;
+    }
+};
+
+class CheckpointReader
+{
+public:
+    // Checks the header; throws std::runtime_error on a foreign or newer file
+    CheckpointReader(std::istream& is, std::uint32_t kind) : is(is)
+    {
+        checkpoint_detail::Header header {};
+        if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != checkpoint_detail::magic) {
+            throw std::runtime_error("Not a checkpoint!!");
+        }
+        if (header.version != checkpoint_detail::formatVersion) {
+            throw std::runtime_error("Unsupported checkpoint version!!");
+        }
+        if (header.kind != kind) {
+            throw std::runtime_error("Checkpoint is for another graph type!!");
+        }
+        // On a seekable stream a vector longer than the rest of it is corrupt
+        // and rejected before its allocation
+        std::streampos here = is.tellg();
+        if (here != std::streampos(-1) && is.seekg(0, std::ios::end)) {
+            std::streampos end = is.tellg();
+            is.seekg(here);
+            if (end != std::streampos(-1) && end >= here) {
+                remaining = static_cast<std::uint64_t>(end - here);
+            }
+        }
+        is.clear();
+    }
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        raw(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void getVector(std::vector<T>& vec)
+    {
+        std::uint64_t count = get<std::uint64_t>();
+        if (count > checkpoint_detail::maxElements || count * sizeof(T) > remaining) {
+            throw std::runtime_error("Corrupt checkpoint!!");
+        }
+        if (remaining != unknown) {
+            vec.resize(count);
+            raw(vec.data(), count * sizeof(T));
+            return;
+        }
+        // Unknown length: grow in chunks so a bad count fails at the end of the stream
+        const std::size_t chunk = (std::size_t(1) << 24) / sizeof(T) + 1;
+        vec.clear();
+        for (std::uint64_t done = 0; done < count;) {
+            std::size_t step = static_cast<std::size_t>(std::min<std::uint64_t>(chunk, count - done));
+            vec.resize(done + step);
+            raw(vec.data() + done, step * sizeof(T));
+            done += step;
+        }
+    }
+
+    // Reads the trailer and checks the size and checksum of everything read
+    void finish()
+    {
+        checkpoint_detail::Trailer trailer {};
+        if (!is.read(reinterpret_cast<char*>(&trailer), sizeof(trailer))) {
+            throw std::runtime_error("Corrupt checkpoint!!");
+        }
+        if (trailer.bytes != bytes || trailer.checksum != sum.value()) {
+            throw std::runtime_error("Checkpoint checksum mismatch!!");
+        }
+    }
+
+private:
+    static constexpr std::uint64_t unknown = ~std::uint64_t(0);
+
+    std::istream& is;
+    Checksum sum;
+    std::uint64_t bytes = 0;
+    std::uint64_t remaining = unknown;     // bytes left in the stream, when it can tell
+
+    void raw(void* data, std::size_t count)
+    {
+        if (count > remaining || !is.read(static_cast<char*>(data), static_cast<std::streamsize>(count))) {
+            throw std::runtime_error("Corrupt checkpoint!!");
+        }
+        sum.update(data, count);
+        bytes += count;
+        remaining -= remaining == unknown ? 0 : count;
+    }
+};
+
+// Writes the live entries of rows 0..n-1 as a Csr, streaming the entries
+// through a small staging buffer instead of building a copy of the graph
+template <typename T, typename Row>
+void putRows(CheckpointWriter& writer, int n, Row row)
+{
+    std::vector<std::size_t> offsets(static_cast<std::size_t>(n) + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        auto live = row(u);
+        offsets[u + 1] = offsets[u] + static_cast<std::size_t>(std::distance(live.begin(), live.end()));
+    }
+    writer.putVector(offsets);
+    writer.beginVector(offsets[n]);
+    std::vector<T> staging;
+    staging.reserve(1 << 14);
+    for (int u = 0; u < n; ++u) {
+        for (const T& e : row(u)) {
+            staging.push_back(e);
+            if (staging.size() == staging.capacity()) {
+                writer.putElements(staging.data(), staging.size());
+                staging.clear();
+            }
+        }
+    }
+    writer.putElements(staging.data(), staging.size());
+}
+
+template <typename T>
+void putCsr(CheckpointWriter& writer, const Csr<T>& csr)
+{
+    writer.putVector(csr.offsets);
+    writer.putVector(csr.entries);
+}
+
+// Reads a Csr of n rows, checking the offsets and that every target is a vertex
+template <typename T>
+Csr<T> getCsr(CheckpointReader& reader, int n)
+{
+    Csr<T> csr;
+    reader.getVector(csr.offsets);
+    reader.getVector(csr.entries);
+    bool valid = csr.offsets.size() == static_cast<std::size_t>(n) + 1
+        && csr.offsets.front() == 0
+        && csr.offsets.back() == csr.entries.size();
+    for (int u = 0; valid && u < n; ++u) {
+        valid = csr.offsets[u] <= csr.offsets[u + 1];
+    }
+    for (std::size_t k = 0; valid && k < csr.entries.size(); ++k) {
+        int v = targetOf(csr.entries[k]);
+        valid = v >= 0 && v < n;
+    }
+    if (!valid) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    return csr;
+}
+
+#endif
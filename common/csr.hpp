@@ -0,0 +1,155 @@
+#ifndef CSR_H
+#define CSR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "parallel.hpp"
+
+// Target vertex of an adjacency entry; negative marks a deleted edge
+inline int targetOf(int e) { return e; }
+
+template <typename W>
+int targetOf(const std::pair<int, W>& e) { return e.first; }
+
+// Read-only view of one adjacency row, whatever container holds it.
+//
+// Iteration skips tombstones: entries whose target is negative, or whose
+// target is flagged in 'removed' when one is given. size() and operator[]
+// address the raw slots, tombstones included.
+template <typename T>
+class NeighborRange
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        iterator() = default;
+        iterator(const T* p, const T* last, const unsigned char* removed) : p(p), last(last), removed(removed) { skip(); }
+
+        const T& operator*() const { return *p; }
+        const T* operator->() const { return p; }
+        iterator& operator++() { ++p; skip(); return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++*this; return tmp; }
+        bool operator==(const iterator& other) const { return p == other.p; }
+        bool operator!=(const iterator& other) const { return p != other.p; }
+
+    private:
+        const T* p = nullptr;
+        const T* last = nullptr;
+        const unsigned char* removed = nullptr;
+
+        void skip()
+        {
+            while (p != last && (targetOf(*p) < 0 || (removed && removed[targetOf(*p)]))) {
+                ++p;
+            }
+        }
+    };
+
+    NeighborRange() = default;
+    NeighborRange(const T* first, const T* last, const unsigned char* removed = nullptr)
+        : first(first), last(last), removed(removed) {}
+
+    template <typename Container>
+    NeighborRange(const Container& row, const unsigned char* removed = nullptr)
+        : first(row.data()), last(row.data() + row.size()), removed(removed) {}
+
+    iterator begin() const { return iterator(first, last, removed); }
+    iterator end() const { return iterator(last, last, removed); }
+    std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    bool empty() const { return begin() == end(); }
+    const T& operator[](std::size_t i) const { return first[i]; }
+
+private:
+    const T* first = nullptr;
+    const T* last = nullptr;
+    const unsigned char* removed = nullptr;
+};
+
+// Compressed sparse rows: the entries of row u are entries[offsets[u], offsets[u + 1])
+template <typename T, typename Alloc = std::allocator<T>>
+struct Csr
+{
+    std::vector<std::size_t, typename std::allocator_traits<Alloc>::template rebind_alloc<std::size_t>> offsets;
+    std::vector<T, Alloc> entries;
+
+    int rows() const { return offsets.empty() ? 0 : static_cast<int>(offsets.size() - 1); }
+    NeighborRange<T> row(int u) const { return {entries.data() + offsets[u], entries.data() + offsets[u + 1]}; }
+};
+
+// Reverses an n-row adjacency by a parallel counting sort.
+//
+// row(u) yields the entries of row u, and flip(u, e) maps entry e of row u to
+// {target row, entry stored there}, where targetOf(entry) is u. Threads count
+// in-degrees and claim slots through one shared array of atomic cursors, so
+// the extra memory is O(n) for any thread count. Rows filled by several
+// threads are then sorted back, so every reversed row lists its entries in
+// increasing source order, as a sequential fill would.
+template <typename T, typename Row, typename Flip>
+Csr<T> reverseCsr(int n, Row row, Flip flip, unsigned threads = 0)
+{
+    const std::size_t rows = static_cast<std::size_t>(n);
+    const std::size_t grain = 1 << 14;
+    const unsigned workers = workerCount(rows, threads, grain);
+
+    // Counts in-degrees into 'cursor', turns them into row starts, then fills
+    // the rows; claim(cursor[v]) returns the next free slot of row v
+    Csr<T> csr;
+    auto fill = [&](auto& cursor, auto claim) {
+        parallelFor(0, rows, [&](std::size_t u) {
+            for (const auto& e : row(static_cast<int>(u))) {
+                claim(cursor[flip(static_cast<int>(u), e).first]);
+            }
+        }, workers, grain);
+
+        csr.offsets.assign(rows + 1, 0);
+        for (std::size_t v = 0; v < rows; ++v) {
+            csr.offsets[v + 1] = csr.offsets[v] + cursor[v];
+            cursor[v] = csr.offsets[v];
+        }
+
+        csr.entries.resize(csr.offsets[rows]);
+        parallelFor(0, rows, [&](std::size_t u) {
+            for (const auto& e : row(static_cast<int>(u))) {
+                auto [v, entry] = flip(static_cast<int>(u), e);
+                csr.entries[claim(cursor[v])] = entry;
+            }
+        }, workers, grain);
+    };
+
+    if (workers <= 1) {
+        std::vector<std::size_t> cursor (rows, 0);
+        fill(cursor, [](std::size_t& c) { return c++; });
+        return csr;
+    }
+
+    std::vector<std::atomic<std::size_t>> cursor (rows);
+    fill(cursor, [](std::atomic<std::size_t>& c) { return c.fetch_add(1, std::memory_order_relaxed); });
+
+    // Only the order between sources is lost: a source's own entries are
+    // claimed by one thread, front to back, so a stable sort by source
+    // restores the sequential layout
+    auto bySource = [](const T& a, const T& b) { return targetOf(a) < targetOf(b); };
+    parallelFor(0, rows, [&](std::size_t v) {
+        auto first = csr.entries.begin() + csr.offsets[v];
+        auto last = csr.entries.begin() + csr.offsets[v + 1];
+        if (!std::is_sorted(first, last, bySource)) {
+            std::stable_sort(first, last, bySource);
+        }
+    }, workers, grain);
+    return csr;
+}
+
+#endif
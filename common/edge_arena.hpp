@@ -0,0 +1,135 @@
+#ifndef EDGE_ARENA_H
+#define EDGE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+// Chunked arena for adjacency rows, usable as a std::pmr::memory_resource.
+//
+// Small blocks are carved from large chunks and rounded up to a power of two.
+// When a row grows and its vector relocates, the old block goes on a free
+// list for its size class and is handed to the next row that needs that
+// size, so doubling growth does not leave holes behind. Blocks larger than a
+// quarter chunk go straight to the upstream resource. release() frees
+// everything at once. Not thread safe, like the graphs that use it.
+class EdgeArena : public std::pmr::memory_resource
+{
+public:
+    explicit EdgeArena(std::size_t chunkSize = std::size_t(1) << 20,
+                       std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : chunkSize(chunkSize)
+        , upstream(upstream)
+    {
+        for (auto& f : freeLists) {
+            f = nullptr;
+        }
+    }
+
+    ~EdgeArena() override { release(); }
+
+    EdgeArena(const EdgeArena&) = delete;
+    EdgeArena& operator=(const EdgeArena&) = delete;
+
+    // Returns all memory to the upstream resource; outstanding blocks become invalid
+    void release()
+    {
+        for (auto& c : chunks) {
+            upstream->deallocate(c.first, c.second, alignof(std::max_align_t));
+        }
+        chunks.clear();
+        for (auto& [p, block] : large) {
+            upstream->deallocate(p, block.first, block.second);
+        }
+        large.clear();
+        for (auto& f : freeLists) {
+            f = nullptr;
+        }
+        cursor = end = nullptr;
+        reserved = 0;
+    }
+
+    // Bytes obtained from the upstream resource
+    std::size_t bytesReserved() const { return reserved; }
+
+private:
+    static constexpr std::size_t minClass = 4;         // 16-byte blocks
+    static constexpr std::size_t classCount = 48;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::size_t chunkSize;
+    std::pmr::memory_resource* upstream;
+    std::vector<std::pair<void*, std::size_t>> chunks;
+    std::unordered_map<void*, std::pair<std::size_t, std::size_t>> large;
+    FreeBlock* freeLists[classCount];
+    char* cursor = nullptr;
+    char* end = nullptr;
+    std::size_t reserved = 0;
+
+    static std::size_t classOf(std::size_t bytes)
+    {
+        std::size_t c = minClass;
+        while ((std::size_t(1) << c) < bytes) {
+            ++c;
+        }
+        return c;
+    }
+
+    bool isLarge(std::size_t bytes, std::size_t alignment) const
+    {
+        return bytes > chunkSize / 4 || alignment > (std::size_t(1) << minClass);
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (isLarge(bytes, alignment)) {
+            void* p = upstream->allocate(bytes, alignment);
+            large[p] = {bytes, alignment};
+            reserved += bytes;
+            return p;
+        }
+        std::size_t c = classOf(bytes);
+        if (FreeBlock* b = freeLists[c]) {
+            freeLists[c] = b->next;
+            return b;
+        }
+        std::size_t size = std::size_t(1) << c;
+        if (static_cast<std::size_t>(end - cursor) < size) {
+            void* chunk = upstream->allocate(chunkSize, alignof(std::max_align_t));
+            chunks.push_back({chunk, chunkSize});
+            reserved += chunkSize;
+            cursor = static_cast<char*>(chunk);
+            end = cursor + chunkSize;
+        }
+        void* p = cursor;
+        cursor += size;
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        if (isLarge(bytes, alignment)) {
+            upstream->deallocate(p, bytes, alignment);
+            large.erase(p);
+            reserved -= bytes;
+            return;
+        }
+        std::size_t c = classOf(bytes);
+        FreeBlock* b = static_cast<FreeBlock*>(p);
+        b->next = freeLists[c];
+        freeLists[c] = b;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for data that readers traverse without locks.
+//
+// A reader pins the current epoch before loading a shared pointer and
+// unpins when done. A writer that unpublishes an object retires it; the
+// object is freed once every reader pinned at or before its retirement has
+// unpinned. Reader slots come in blocks; when every slot is pinned, pin()
+// links a new block, so any number of readers can be pinned at once. Blocks
+// live as long as the manager. All atomics use sequentially consistent
+// ordering.
+class EpochManager
+{
+public:
+    // Reader slots per block
+    static constexpr int slotsPerBlock = 256;
+
+    // RAII pin; releases its reader slot when destroyed
+    class Guard
+    {
+    public:
+        Guard(Guard&& other) noexcept : slot(other.slot) { other.slot = nullptr; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard()
+        {
+            if (slot) {
+                slot->store(0);
+            }
+        }
+
+    private:
+        friend class EpochManager;
+        explicit Guard(std::atomic<std::uint64_t>* slot) : slot(slot) {}
+        std::atomic<std::uint64_t>* slot;
+    };
+
+    EpochManager() = default;
+
+    ~EpochManager()
+    {
+        for (auto& r : retired) {
+            r.free();
+        }
+        for (SlotBlock* b = first.next.load(); b;) {
+            SlotBlock* next = b->next.load();
+            delete b;
+            b = next;
+        }
+    }
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // Pins the current epoch; shared pointers must be loaded after this
+    Guard pin()
+    {
+        std::uint64_t e = epoch.load();
+        for (SlotBlock* b = &first;;) {
+            for (auto& s : b->slots) {
+                std::uint64_t expected = 0;
+                if (s.load() == 0 && s.compare_exchange_strong(expected, e)) {
+                    return Guard(&s);
+                }
+            }
+            // Every slot so far is pinned: move on, linking a block if there is none
+            SlotBlock* next = b->next.load();
+            if (!next) {
+                auto grown = std::make_unique<SlotBlock>();
+                if (b->next.compare_exchange_strong(next, grown.get())) {
+                    next = grown.release();
+                }
+            }
+            b = next;
+        }
+    }
+
+    // Schedules 'free' to run once no reader can still see the unpublished object
+    void retire(std::function<void()> free)
+    {
+        std::uint64_t e = epoch.fetch_add(1) + 1;
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        retired.push_back({e, std::move(free)});
+    }
+
+    // Frees every retired object that no pinned reader can reach; returns how many
+    std::size_t collect()
+    {
+        std::uint64_t oldest = UINT64_MAX;
+        for (const SlotBlock* b = &first; b; b = b->next.load()) {
+            for (auto& s : b->slots) {
+                std::uint64_t e = s.load();
+                if (e != 0 && e < oldest) {
+                    oldest = e;
+                }
+            }
+        }
+        std::vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retiredMutex);
+            std::size_t kept = 0;
+            for (auto& r : retired) {
+                if (r.epoch <= oldest) {
+                    ready.push_back(std::move(r));
+                } else {
+                    retired[kept++] = std::move(r);
+                }
+            }
+            retired.resize(kept);
+        }
+        for (auto& r : ready) {
+            r.free();
+        }
+        return ready.size();
+    }
+
+    // Number of retired objects still waiting for readers
+    std::size_t pending() const
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        return retired.size();
+    }
+
+private:
+    struct Retired
+    {
+        std::uint64_t epoch;
+        std::function<void()> free;
+    };
+
+    struct SlotBlock
+    {
+        std::atomic<std::uint64_t> slots[slotsPerBlock] {};
+        std::atomic<SlotBlock*> next {nullptr};
+    };
+
+    std::atomic<std::uint64_t> epoch {1};
+    SlotBlock first;
+    mutable std::mutex retiredMutex;
+    std::vector<Retired> retired;
+};
+
+#endif
@@ -0,0 +1,501 @@
+#ifndef GRAPH_KERNELS_H
+#define GRAPH_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "instrument.hpp"
+
+// Traversal algorithms written once for every graph backend.
+//
+// A graph here is anything with size() and forEachNeighbor(u, f), which calls
+// f(v, weight) for every out-edge u -> v. When it also has isRemoved(u),
+// removed vertices never start a whole-graph search. Vertex ids have the type
+// size() returns. BasicGraph provides this interface itself; Vertex and the two
+// Graph classes wrap their rows with neighborGraph().
+
+// Weight passed for edges of unweighted graphs
+struct NoWeight {};
+
+template <typename G>
+using VertexIdOf = std::decay_t<decltype(std::declval<const G&>().size())>;
+
+namespace graph_kernels_detail {
+
+template <typename G, typename = void>
+struct HasIsRemoved : std::false_type {};
+
+template <typename G>
+struct HasIsRemoved<G, std::void_t<decltype(std::declval<const G&>().isRemoved(VertexIdOf<G> {}))>>
+    : std::true_type {};
+
+template <typename G>
+bool isLive(const G& g, VertexIdOf<G> u)
+{
+    if constexpr (HasIsRemoved<G>::value) {
+        return !g.isRemoved(u);
+    } else {
+        (void)g;
+        (void)u;
+        return true;
+    }
+}
+
+} // namespace graph_kernels_detail
+
+// Graph given by a visitor: visit(u, f) calls f(v, weight) for every out-edge
+// of u and removed(u) flags removed vertices
+template <typename Id, typename Visit, typename Removed>
+class NeighborGraph
+{
+public:
+    NeighborGraph(Id n, Visit visit, Removed removed) : n(n), visit(std::move(visit)), removed(std::move(removed)) {}
+
+    Id size() const { return n; }
+
+    template <typename F>
+    void forEachNeighbor(Id u, F&& f) const
+    {
+        visit(u, f);
+    }
+
+    bool isRemoved(Id u) const { return removed(u); }
+
+private:
+    Id n;
+    Visit visit;
+    Removed removed;
+};
+
+template <typename Id, typename Visit, typename Removed>
+NeighborGraph<Id, Visit, Removed> neighborGraph(Id n, Visit visit, Removed removed)
+{
+    return NeighborGraph<Id, Visit, Removed>(n, std::move(visit), std::move(removed));
+}
+
+// Number of vertices that are not removed
+template <typename G>
+std::size_t liveVertexCount(const G& g)
+{
+    std::size_t count = 0;
+    for (VertexIdOf<G> u = 0; u < g.size(); ++u) {
+        count += graph_kernels_detail::isLive(g, u);
+    }
+    return count;
+}
+
+// Breadth First Search order from start
+template <typename G>
+std::vector<VertexIdOf<G>> bfsOrder(const G& g, VertexIdOf<G> start)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> order {start};
+    visit[start] = 1;
+    for (std::size_t head = 0; head < order.size();) {
+        // One level at a time so the frontier size can be recorded
+        const std::size_t levelEnd = order.size();
+        GRAPH_FRONTIER(levelEnd - head);
+        for (; head < levelEnd; ++head) {
+            GRAPH_VISIT();
+            g.forEachNeighbor(order[head], [&](Id v, auto) {
+                GRAPH_EDGE();
+                if (!visit[v]) {
+                    visit[v] = 1;
+                    order.push_back(v);
+                }
+            });
+        }
+    }
+    return order;
+}
+
+// Iterative Depth First Search order from start; a vertex is marked when pushed
+template <typename G>
+std::vector<VertexIdOf<G>> dfsOrder(const G& g, VertexIdOf<G> start)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> order;
+    std::vector<Id> st {start};
+    visit[start] = 1;
+    while (!st.empty()) {
+        Id x = st.back();
+        st.pop_back();
+        order.push_back(x);
+        GRAPH_VISIT();
+        g.forEachNeighbor(x, [&](Id v, auto) {
+            GRAPH_EDGE();
+            if (!visit[v]) {
+                visit[v] = 1;
+                st.push_back(v);
+            }
+        });
+    }
+    return order;
+}
+
+// Depth First Search from root in the order a recursive one takes, without
+// recursion. enter(u, parent) runs when u is reached (the root is its own
+// parent), edge(u, v, tree) for every out-edge once v is settled: tree is true
+// when u reached v and v's search just ended. leave(u) runs when u is done.
+// Vertices with visit set are skipped and reached ones get it set; leave() may
+// clear it again to let later paths pass through u.
+template <typename G, typename Enter, typename Edge, typename Leave>
+void depthFirstSearch(const G& g, VertexIdOf<G> root, std::vector<unsigned char>& visit, Enter&& enter, Edge&& edge,
+                      Leave&& leave)
+{
+    using Id = VertexIdOf<G>;
+    // Each frame reads its successors from succ[begin, end); a frame's range is
+    // dropped when it ends, so succ holds the successors of the current path only
+    struct Frame
+    {
+        Id u;
+        std::size_t next;
+        std::size_t begin;
+    };
+    std::vector<Frame> frames;
+    std::vector<Id> succ;
+    auto push = [&](Id u, Id parent) {
+        visit[u] = 1;
+        GRAPH_VISIT();
+        enter(u, parent);
+        const std::size_t begin = succ.size();
+        g.forEachNeighbor(u, [&](Id v, auto) { succ.push_back(v); });
+        frames.push_back({u, begin, begin});
+    };
+
+    push(root, root);
+    while (!frames.empty()) {
+        Frame& top = frames.back();
+        const Id u = top.u;
+        if (top.next < succ.size()) {
+            const Id v = succ[top.next++];
+            GRAPH_EDGE();
+            if (!visit[v]) {
+                push(v, u);
+            } else {
+                edge(u, v, false);
+            }
+            continue;
+        }
+        succ.resize(top.begin);
+        frames.pop_back();
+        leave(u);
+        if (!frames.empty()) {
+            edge(frames.back().u, u, true);
+        }
+    }
+}
+
+// Depth First Search from root calling enter(u) on every vertex it reaches
+// and leave(u) once u is done, in recursive order
+template <typename G, typename Enter, typename Leave>
+void depthFirst(const G& g, VertexIdOf<G> root, std::vector<unsigned char>& visit, Enter&& enter, Leave&& leave)
+{
+    using Id = VertexIdOf<G>;
+    depthFirstSearch(g, root, visit, [&](Id u, Id) { enter(u); }, [](Id, Id, bool) {}, leave);
+}
+
+// Vertices in the order a recursive Depth First Search from start reaches them
+template <typename G>
+std::vector<VertexIdOf<G>> preorder(const G& g, VertexIdOf<G> start)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> order;
+    depthFirst(g, start, visit, [&](Id u) { order.push_back(u); }, [](Id) {});
+    return order;
+}
+
+// Fewest-hops path from u to v, empty if v is unreachable
+template <typename G>
+std::vector<VertexIdOf<G>> hopPath(const G& g, VertexIdOf<G> u, VertexIdOf<G> v)
+{
+    using Id = VertexIdOf<G>;
+    const Id none = std::numeric_limits<Id>::max();
+    std::vector<Id> parent(g.size(), none);
+    std::vector<Id> queue {u};
+    parent[u] = u;
+    for (std::size_t head = 0; head < queue.size() && parent[v] == none; ++head) {
+        const Id x = queue[head];
+        GRAPH_VISIT();
+        g.forEachNeighbor(x, [&](Id y, auto) {
+            GRAPH_EDGE();
+            if (parent[y] == none) {
+                parent[y] = x;
+                queue.push_back(y);
+            }
+        });
+    }
+    if (parent[v] == none) {
+        return {};
+    }
+    std::vector<Id> path {v};
+    while (path.back() != u) {
+        path.push_back(parent[path.back()]);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+// Number of vertices exactly 'level' hops from start; level must not be negative
+template <typename G>
+std::size_t countAtLevel(const G& g, VertexIdOf<G> start, int level)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> frontier {start}, next;
+    visit[start] = 1;
+    for (int l = 0; l < level && !frontier.empty(); ++l) {
+        GRAPH_FRONTIER(frontier.size());
+        next.clear();
+        for (Id x : frontier) {
+            GRAPH_VISIT();
+            g.forEachNeighbor(x, [&](Id y, auto) {
+                GRAPH_EDGE();
+                if (!visit[y]) {
+                    visit[y] = 1;
+                    next.push_back(y);
+                }
+            });
+        }
+        frontier.swap(next);
+    }
+    return frontier.size();
+}
+
+// Every simple path from src to dest, in the order a recursive search finds them
+template <typename G>
+std::vector<std::vector<VertexIdOf<G>>> allSimplePaths(const G& g, VertexIdOf<G> src, VertexIdOf<G> dest)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> path;
+    std::vector<std::vector<Id>> paths;
+    depthFirst(
+        g, src, visit,
+        [&](Id u) {
+            path.push_back(u);
+            if (u == dest) {
+                paths.push_back(path);
+            }
+        },
+        [&](Id u) {
+            path.pop_back();
+            visit[u] = 0;
+        });
+    return paths;
+}
+
+// Kahn's topological order of the live vertices; shorter than
+// liveVertexCount(g) exactly when the graph has a cycle
+template <typename G>
+std::vector<VertexIdOf<G>> kahnOrder(const G& g)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<std::size_t> indegree(g.size(), 0);
+    for (Id u = 0; u < g.size(); ++u) {
+        g.forEachNeighbor(u, [&](Id v, auto) { ++indegree[v]; });
+    }
+    std::vector<Id> order;
+    for (Id u = 0; u < g.size(); ++u) {
+        if (indegree[u] == 0 && graph_kernels_detail::isLive(g, u)) {
+            order.push_back(u);
+        }
+    }
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        GRAPH_VISIT();
+        g.forEachNeighbor(order[head], [&](Id v, auto) {
+            GRAPH_EDGE();
+            if (--indegree[v] == 0) {
+                order.push_back(v);
+            }
+        });
+    }
+    return order;
+}
+
+// Topological order by Depth First Search: vertices by decreasing finishing time
+template <typename G>
+std::vector<VertexIdOf<G>> finishOrder(const G& g)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> order;
+    for (Id u = 0; u < g.size(); ++u) {
+        if (!visit[u] && graph_kernels_detail::isLive(g, u)) {
+            depthFirst(g, u, visit, [](Id) {}, [&](Id x) { order.push_back(x); });
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Checks whether a directed graph has a cycle: some edge closes back onto the search path
+template <typename G>
+bool hasDirectedCycle(const G& g)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0), onPath(g.size(), 0);
+    bool cycled = false;
+    for (Id u = 0; u < g.size() && !cycled; ++u) {
+        if (!visit[u] && graph_kernels_detail::isLive(g, u)) {
+            depthFirstSearch(
+                g, u, visit, [&](Id x, Id) { onPath[x] = 1; },
+                [&](Id, Id y, bool tree) { cycled |= !tree && onPath[y]; }, [&](Id x) { onPath[x] = 0; });
+        }
+    }
+    return cycled;
+}
+
+// Checks whether an undirected graph, stored with both directions of every
+// edge, has a cycle: an edge to a reached vertex other than the parent, or a
+// self-loop. A repeated edge between two vertices does not count.
+template <typename G>
+bool hasUndirectedCycle(const G& g)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<Id> parent(g.size());
+    bool cycled = false;
+    for (Id u = 0; u < g.size() && !cycled; ++u) {
+        if (!visit[u] && graph_kernels_detail::isLive(g, u)) {
+            depthFirstSearch(
+                g, u, visit, [&](Id x, Id p) { parent[x] = p; },
+                [&](Id x, Id y, bool tree) { cycled |= !tree && (y == x || y != parent[x]); }, [](Id) {});
+        }
+    }
+    return cycled;
+}
+
+// Labels every live vertex with the index of the component a search over
+// out-edges from the lowest unlabelled vertex gives it, removed ones with -1
+template <typename G>
+std::vector<int> componentLabels(const G& g)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<int> labels(g.size(), -1);
+    std::vector<Id> queue;
+    int count = 0;
+    for (Id root = 0; root < g.size(); ++root) {
+        if (labels[root] != -1 || !graph_kernels_detail::isLive(g, root)) {
+            continue;
+        }
+        labels[root] = count;
+        queue.assign(1, root);
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            g.forEachNeighbor(queue[head], [&](Id v, auto) {
+                if (labels[v] == -1) {
+                    labels[v] = count;
+                    queue.push_back(v);
+                }
+            });
+        }
+        ++count;
+    }
+    return labels;
+}
+
+// Tarjan's strongly connected components, in the order their roots finish
+template <typename G>
+std::vector<std::vector<VertexIdOf<G>>> tarjanComponents(const G& g)
+{
+    using Id = VertexIdOf<G>;
+    const Id n = g.size();
+    std::vector<std::size_t> ids(n, 0), lowlink(n, 0);
+    std::vector<unsigned char> visit(n, 0), onStack(n, 0);
+    std::vector<Id> st;
+    std::vector<std::vector<Id>> SCCs;
+    std::size_t time = 0;
+    for (Id root = 0; root < n; ++root) {
+        if (visit[root] || !graph_kernels_detail::isLive(g, root)) {
+            continue;
+        }
+        depthFirstSearch(
+            g, root, visit,
+            [&](Id u, Id) {
+                ids[u] = lowlink[u] = time++;
+                st.push_back(u);
+                onStack[u] = 1;
+            },
+            [&](Id u, Id v, bool) {
+                if (onStack[v]) {
+                    lowlink[u] = std::min(lowlink[u], lowlink[v]);
+                }
+            },
+            [&](Id u) {
+                if (lowlink[u] != ids[u]) {
+                    return;
+                }
+                std::vector<Id> comp;
+                Id w;
+                do {
+                    w = st.back();
+                    st.pop_back();
+                    onStack[w] = 0;
+                    comp.push_back(w);
+                } while (w != u);
+                SCCs.push_back(std::move(comp));
+            });
+    }
+    return SCCs;
+}
+
+// Kosaraju's strongly connected components: finishing order over g, then
+// searches over 'in', a graph holding the in-edges of g
+template <typename G, typename In>
+std::vector<std::vector<VertexIdOf<G>>> kosarajuComponents(const G& g, const In& in)
+{
+    using Id = VertexIdOf<G>;
+    std::vector<unsigned char> visit(g.size(), 0);
+    std::vector<std::vector<Id>> SCCs;
+    for (Id u : finishOrder(g)) {
+        if (!visit[u]) {
+            std::vector<Id> comp;
+            depthFirst(in, u, visit, [&](Id x) { comp.push_back(x); }, [](Id) {});
+            SCCs.push_back(std::move(comp));
+        }
+    }
+    return SCCs;
+}
+
+// Dijkstra's single source distances over non-negative weights; unreachable
+// vertices keep max()
+template <typename Distance, typename G>
+std::vector<Distance> dijkstraDistances(const G& g, VertexIdOf<G> source)
+{
+    using Id = VertexIdOf<G>;
+    const Distance inf = std::numeric_limits<Distance>::max();
+    std::vector<Distance> dist(g.size(), inf);
+    using Item = std::pair<Distance, Id>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> pq;
+    dist[source] = 0;
+    pq.push({0, source});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) {
+            GRAPH_STALE_POP();
+            continue;
+        }
+        GRAPH_VISIT();
+        g.forEachNeighbor(u, [&](Id v, auto w) {
+            GRAPH_EDGE();
+            Distance nd = d + static_cast<Distance>(w);
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                pq.push({nd, v});
+                GRAPH_HEAP_PUSH();
+            }
+        });
+    }
+    return dist;
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef GRAPH_KERNELS_ASYNC_H
+#define GRAPH_KERNELS_ASYNC_H
+
+// Coroutine algorithms written once for Vertex and the weighted Graph.
+// Requires C++20.
+//
+// 'graph' provides size() and isRemoved(u). rows(u) returns the stored row
+// of u as a NeighborRange<int>: size() and operator[] address every slot,
+// tombstones included, and iteration skips them. Each coroutine yields as
+// common/async.hpp describes, and the graph must not change while it runs.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "async.hpp"
+
+// Kosaraju's algorithm for strongly connected components, without transposing the graph
+template <typename GraphT, typename Rows>
+Task<std::vector<std::vector<int>>> kosarajuAsync(const GraphT& graph, Rows rows, AsyncContext ctx)
+{
+    const int n = graph.size();
+    std::uint64_t m = 0;
+    for (int u = 0; u < n; ++u) {
+        m += rows(u).size();
+    }
+    ctx.progress->total = 3 * m;
+
+    // Finishing order of an iterative DFS
+    std::vector<int> order;
+    std::vector<bool> visit (n, false);
+    std::vector<std::pair<int, std::size_t>> frames;
+    for (int i = 0; i < n; ++i) {
+        if (visit[i] || graph.isRemoved(i)) {
+            continue;
+        }
+        visit[i] = true;
+        frames.push_back({i, 0});
+        while (!frames.empty()) {
+            auto& [u, k] = frames.back();
+            const auto adj = rows(u);
+            if (k == adj.size()) {
+                order.push_back(u);
+                frames.pop_back();
+                continue;
+            }
+            int v = adj[k++];
+            if (v >= 0 && !graph.isRemoved(v) && !visit[v]) {
+                visit[v] = true;
+                frames.push_back({v, 0});
+            }
+            if (ctx.tick()) {
+                co_await ctx.yield();
+            }
+        }
+    }
+
+    // Transposed adjacency as CSR
+    std::vector<std::size_t> offsets (n + 1, 0);
+    for (int u = 0; u < n; ++u) {
+        for (int v : rows(u)) {
+            ++offsets[v + 1];
+        }
+    }
+    for (int u = 0; u < n; ++u) {
+        offsets[u + 1] += offsets[u];
+    }
+    std::vector<int> reverse (m);
+    std::vector<std::size_t> fill (offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < n; ++u) {
+        for (int v : rows(u)) {
+            reverse[fill[v]++] = u;
+        }
+        if (ctx.tick(rows(u).size())) {
+            co_await ctx.yield();
+        }
+    }
+
+    // Components in decreasing finishing order on the transpose
+    std::vector<std::vector<int>> res;
+    visit.assign(n, false);
+    std::vector<int> st;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        if (visit[*it]) {
+            continue;
+        }
+        std::vector<int> component;
+        visit[*it] = true;
+        st.push_back(*it);
+        while (!st.empty()) {
+            int u = st.back();
+            st.pop_back();
+            component.push_back(u);
+            for (std::size_t k = offsets[u]; k < offsets[u + 1]; ++k) {
+                if (!visit[reverse[k]]) {
+                    visit[reverse[k]] = true;
+                    st.push_back(reverse[k]);
+                }
+            }
+            if (ctx.tick(offsets[u + 1] - offsets[u] + 1)) {
+                co_await ctx.yield();
+            }
+        }
+        res.push_back(std::move(component));
+    }
+    ctx.finish();
+    co_return res;
+}
+
+// Every simple path from 'src' to 'dest'
+template <typename GraphT, typename Rows>
+Task<std::vector<std::vector<int>>> allSimplePathsAsync(const GraphT& graph, Rows rows, int src, int dest,
+                                                        AsyncContext ctx)
+{
+    std::vector<std::vector<int>> res;
+    std::vector<int> path {src};
+    std::vector<std::size_t> next {0};
+    std::vector<bool> visit (graph.size(), false);
+    visit[src] = true;
+    if (src == dest) {
+        res.push_back(path);
+    }
+    while (!path.empty()) {
+        int u = path.back();
+        const auto adj = rows(u);
+        if (next.back() == adj.size()) {
+            visit[u] = false;
+            path.pop_back();
+            next.pop_back();
+            continue;
+        }
+        int v = adj[next.back()++];
+        if (v >= 0 && !graph.isRemoved(v) && !visit[v]) {
+            visit[v] = true;
+            path.push_back(v);
+            next.push_back(0);
+            if (v == dest) {
+                res.push_back(path);
+            }
+        }
+        if (ctx.tick()) {
+            co_await ctx.yield();
+        }
+    }
+    ctx.finish();
+    co_return res;
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef HYPERANF_H
+#define HYPERANF_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "csr.hpp"
+#include "memory_policy.hpp"
+#include "parallel.hpp"
+
+struct HyperAnfOptions
+{
+    // log2 of the registers per counter, 4..16; relative error is about 1.04 / sqrt(2^precision)
+    int precision = 6;
+    std::uint64_t seed = 1;
+    unsigned threads = 0;
+};
+
+struct NeighborhoodFunction
+{
+    // balls[t][v]: estimated number of vertices within t hops of v along out-edges.
+    // Ends early once no counter changes; every later hop equals the last one.
+    std::vector<std::vector<double>> balls;
+    // total[t]: sum of balls[t], the number of pairs at distance t or less
+    std::vector<double> total;
+};
+
+namespace hyperanf_detail {
+
+const std::uint64_t highBits = 0x8080808080808080ull;
+
+// Bytewise max of two words holding 8-bit registers below 128
+inline std::uint64_t maxBytes(std::uint64_t x, std::uint64_t y)
+{
+    // High bit of each byte of (x | H) - y is set where x >= y; no borrow crosses bytes
+    std::uint64_t ge = (((x | highBits) - y) & highBits) >> 7;
+    std::uint64_t mask = ge * 0xFF;
+    return (x & mask) | (y & ~mask);
+}
+
+inline std::uint64_t mix(std::uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// HyperLogLog estimate from 2^precision one-byte registers, with linear counting for small sets
+inline double estimate(const std::uint8_t* reg, int precision)
+{
+    const int m = 1 << precision;
+    double sum = 0;
+    int zeros = 0;
+    for (int i = 0; i < m; ++i) {
+        sum += std::ldexp(1.0, -reg[i]);
+        zeros += reg[i] == 0;
+    }
+    double alpha = m == 16 ? 0.673 : m == 32 ? 0.697 : m == 64 ? 0.709 : 0.7213 / (1.0 + 1.079 / m);
+    double e = alpha * m * m / sum;
+    if (e <= 2.5 * m && zeros > 0) {
+        e = m * std::log(static_cast<double>(m) / zeros);
+    }
+    return e;
+}
+
+} // namespace hyperanf_detail
+
+// HyperANF: approximate sizes of the balls of radius 0..hops around every vertex.
+//
+// Each vertex keeps a HyperLogLog counter of 2^precision one-byte registers,
+// packed eight to a word. Iteration t sets the counter of v to the union of
+// its own and its out-neighbors' counters from iteration t - 1, a bytewise
+// max done eight registers per word. Only vertices with an out-neighbor whose
+// counter changed in the previous round are merged again. Time is O(hops * E)
+// word operations and memory two counters per vertex. 'Graph' needs size(),
+// isRemoved() and neighbors(); removed vertices get 0.
+template <typename Graph>
+NeighborhoodFunction hyperAnf(const Graph& graph, int hops, const HyperAnfOptions& options = {})
+{
+    using namespace hyperanf_detail;
+
+    if (options.precision < 4 || options.precision > 16) {
+        throw std::invalid_argument("Invalid precision!!");
+    }
+    if (hops < 0) {
+        throw std::invalid_argument("Invalid level!!");
+    }
+    const int n = graph.size();
+    const int p = options.precision;
+    const std::size_t words = (std::size_t(1) << p) / 8;
+    const std::size_t grain = 256;
+    PolicyArray<std::uint64_t> current(std::size_t(n) * words, 0);
+    PolicyArray<std::uint64_t> next(current.size(), 0);
+    std::vector<unsigned char> changed(n, 0);
+    std::vector<unsigned char> changing(n, 0);
+    auto registers = [&](PolicyArray<std::uint64_t>& counters, int v) {
+        return reinterpret_cast<std::uint8_t*>(counters.data() + std::size_t(v) * words);
+    };
+
+    // Radius 0: every vertex counts itself. Registers hold rank = leading zeros + 1 of the
+    // hash bits below the index, capped so they always stay below 128.
+    parallelFor(0, n, [&](std::size_t v) {
+        if (graph.isRemoved(static_cast<int>(v))) {
+            return;
+        }
+        std::uint64_t h = mix(v ^ mix(options.seed));
+        std::size_t index = h >> (64 - p);
+        std::uint64_t rest = h << p;
+        int rank = rest ? __builtin_clzll(rest) + 1 : 64 - p + 1;
+        registers(current, static_cast<int>(v))[index] = static_cast<std::uint8_t>(rank);
+        changed[v] = 1;
+    }, options.threads, grain);
+
+    NeighborhoodFunction result;
+    auto record = [&] {
+        std::vector<double> ball(n, 0.0);
+        parallelFor(0, n, [&](std::size_t v) {
+            if (!graph.isRemoved(static_cast<int>(v))) {
+                ball[v] = estimate(registers(current, static_cast<int>(v)), p);
+            }
+        }, options.threads, grain);
+        double sum = 0;
+        for (double b : ball) {
+            sum += b;
+        }
+        result.balls.push_back(std::move(ball));
+        result.total.push_back(sum);
+    };
+    record();
+
+    const unsigned workers = workerCount(n, options.threads, grain);
+    const MemoryPolicy policy = MemoryPolicy::active();
+    for (int t = 1; t <= hops; ++t) {
+        std::vector<unsigned char> any(workers, 0);
+        pinnedParallelForWorker(0, n, [&](unsigned worker, std::size_t v) {
+            const std::uint64_t* own = current.data() + v * words;
+            std::uint64_t* out = next.data() + v * words;
+            std::copy(own, own + words, out);
+            changing[v] = 0;
+            for (const auto& e : graph.neighbors(static_cast<int>(v))) {
+                int w = targetOf(e);
+                if (!changed[w]) {
+                    continue;
+                }
+                const std::uint64_t* theirs = current.data() + std::size_t(w) * words;
+                for (std::size_t k = 0; k < words; ++k) {
+                    out[k] = maxBytes(out[k], theirs[k]);
+                }
+            }
+            for (std::size_t k = 0; k < words; ++k) {
+                if (out[k] != own[k]) {
+                    changing[v] = 1;
+                    any[worker] = 1;
+                    break;
+                }
+            }
+        }, policy, workers, grain);
+        if (std::find(any.begin(), any.end(), 1) == any.end()) {
+            break;
+        }
+        current.swap(next);
+        changed.swap(changing);
+        record();
+    }
+    return result;
+}
+
+#endif
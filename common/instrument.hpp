@@ -0,0 +1,210 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// Opt-in instrumentation for the traversal kernels.
+//
+// Build with -DGRAPH_INSTRUMENT to enable it. Without that flag every
+// GRAPH_* macro below expands to nothing, so the kernels compile exactly
+// as before.
+//
+// Each instrumented kernel opens a scope, and its counters are appended to a
+// per-thread history when the scope closes. instrument::report() writes that
+// history as JSON.
+
+#ifdef GRAPH_INSTRUMENT
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace instrument {
+
+// Counters collected for one kernel invocation
+struct Stats
+{
+    const char* kernel = "";
+    std::uint64_t edgesExamined = 0;
+    std::uint64_t verticesVisited = 0;
+    std::uint64_t heapPushes = 0;
+    std::uint64_t stalePops = 0;
+    int depth = 0;
+    int maxDepth = 0;
+    std::vector<std::uint64_t> frontierSizes;
+    long long cacheMisses = -1;   // -1 when perf counters are unavailable
+};
+
+// Per-thread stack of open scopes and history of closed ones
+inline thread_local std::vector<Stats> openScopes;
+inline thread_local std::vector<Stats> history;
+inline bool perfEnabled = false;
+
+// Enables the perf_event_open cache-miss hook for subsequent scopes
+inline void setPerfEnabled(bool on) { perfEnabled = on; }
+
+// Counters of the innermost open scope (a dummy when none is open)
+inline Stats& current()
+{
+    static thread_local Stats dummy;
+    return openScopes.empty() ? dummy : openScopes.back();
+}
+
+// Hardware cache-miss counter; silently unavailable when the kernel refuses
+class PerfCounter
+{
+public:
+    PerfCounter()
+    {
+#ifdef __linux__
+        if (!perfEnabled) {
+            return;
+        }
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    ~PerfCounter()
+    {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    // Returns the number of cache misses so far, or -1 if not available
+    long long read() const
+    {
+#ifdef __linux__
+        if (fd >= 0) {
+            long long count = 0;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (::read(fd, &count, sizeof(count)) == sizeof(count)) {
+                return count;
+            }
+        }
+#endif
+        return -1;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Opens a scope for one kernel invocation
+class Scope
+{
+public:
+    explicit Scope(const char* kernel)
+    {
+        openScopes.emplace_back();
+        openScopes.back().kernel = kernel;
+    }
+
+    ~Scope()
+    {
+        Stats s = std::move(openScopes.back());
+        s.cacheMisses = perf.read();
+        openScopes.pop_back();
+        history.push_back(std::move(s));
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    PerfCounter perf;
+};
+
+// Tracks recursion depth for the lifetime of one recursive call
+class DepthGuard
+{
+public:
+    DepthGuard()
+    {
+        Stats& s = current();
+        if (++s.depth > s.maxDepth) {
+            s.maxDepth = s.depth;
+        }
+    }
+
+    ~DepthGuard() { --current().depth; }
+};
+
+// Writes the history of this thread as a JSON array
+inline void report(std::ostream& os)
+{
+    os << "[";
+    for (std::size_t i = 0; i < history.size(); ++i) {
+        const Stats& s = history[i];
+        os << (i ? ",\n " : "\n ") << "{\"kernel\": \"" << s.kernel << "\""
+           << ", \"edgesExamined\": " << s.edgesExamined
+           << ", \"verticesVisited\": " << s.verticesVisited
+           << ", \"heapPushes\": " << s.heapPushes
+           << ", \"stalePops\": " << s.stalePops
+           << ", \"maxRecursionDepth\": " << s.maxDepth
+           << ", \"frontierSizes\": [";
+        for (std::size_t j = 0; j < s.frontierSizes.size(); ++j) {
+            os << (j ? ", " : "") << s.frontierSizes[j];
+        }
+        os << "], \"cacheMisses\": ";
+        if (s.cacheMisses < 0) {
+            os << "null";
+        } else {
+            os << s.cacheMisses;
+        }
+        os << "}";
+    }
+    os << "\n]" << std::endl;
+}
+
+// Drops the history of this thread
+inline void clear() { history.clear(); }
+
+} // namespace instrument
+
+#define GRAPH_CONCAT_IMPL(a, b) a##b
+#define GRAPH_CONCAT(a, b) GRAPH_CONCAT_IMPL(a, b)
+#define GRAPH_SCOPE(name) instrument::Scope GRAPH_CONCAT(graphScope_, __LINE__)(name)
+#define GRAPH_RECURSION() instrument::DepthGuard GRAPH_CONCAT(graphDepth_, __LINE__)
+#define GRAPH_EDGE() (++instrument::current().edgesExamined)
+#define GRAPH_VISIT() (++instrument::current().verticesVisited)
+#define GRAPH_FRONTIER(n) (instrument::current().frontierSizes.push_back(n))
+#define GRAPH_HEAP_PUSH() (++instrument::current().heapPushes)
+#define GRAPH_STALE_POP() (++instrument::current().stalePops)
+
+#else
+
+#define GRAPH_SCOPE(name)
+#define GRAPH_RECURSION()
+#define GRAPH_EDGE()
+#define GRAPH_VISIT()
+#define GRAPH_FRONTIER(n)
+#define GRAPH_HEAP_PUSH()
+#define GRAPH_STALE_POP()
+
+#endif
+
+#endif
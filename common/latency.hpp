@@ -0,0 +1,80 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free latency histogram with log-linear buckets.
+//
+// Values are bucketed by power of two with 8 linear sub-buckets each, so a
+// reported percentile is within 12.5% of the true value.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram()
+    {
+        for (auto& b : buckets) {
+            b.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Records one sample in nanoseconds
+    void record(std::uint64_t ns)
+    {
+        buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Number of samples recorded
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding quantile q (0 < q <= 1), in nanoseconds
+    std::uint64_t percentile(double q) const
+    {
+        std::uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(q * n);
+        if (rank == 0) {
+            rank = 1;
+        }
+        std::uint64_t seen = 0;
+        for (int i = 0; i < bucketCount; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return upperBound(i);
+            }
+        }
+        return upperBound(bucketCount - 1);
+    }
+
+private:
+    static constexpr int subBits = 3;
+    static constexpr int bucketCount = 64 << subBits;
+
+    std::atomic<std::uint64_t> buckets[bucketCount];
+    std::atomic<std::uint64_t> total {0};
+
+    static int bucketOf(std::uint64_t v)
+    {
+        if (v < (1u << subBits)) {
+            return static_cast<int>(v);
+        }
+        int exp = 63 - __builtin_clzll(v);
+        int sub = static_cast<int>((v >> (exp - subBits)) & ((1 << subBits) - 1));
+        return ((exp - subBits + 1) << subBits) + sub;
+    }
+
+    static std::uint64_t upperBound(int bucket)
+    {
+        if (bucket < (1 << subBits)) {
+            return bucket;
+        }
+        int exp = (bucket >> subBits) + subBits - 1;
+        std::uint64_t sub = bucket & ((1 << subBits) - 1);
+        return ((std::uint64_t(1) << subBits | sub) + 1) << (exp - subBits);
+    }
+};
+
+#endif
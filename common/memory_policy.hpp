@@ -0,0 +1,511 @@
+#ifndef MEMORY_POLICY_H
+#define MEMORY_POLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "parallel.hpp"
+
+// Where the pages of a large array go on a multi-socket machine
+enum class NumaPlacement
+{
+    local,          // first touch, the kernel default
+    interleave,     // round-robin over all nodes
+    partition,      // one contiguous slice per node, matching pinned workers
+};
+
+// Page size requested for large arrays
+enum class HugePages
+{
+    off,
+    transparent,    // madvise(MADV_HUGEPAGE) on 2 MiB aligned mappings
+    explicit_,      // MAP_HUGETLB from the reserved pool, else transparent
+};
+
+// Memory and thread placement for the big arrays of graph algorithms. Only
+// code that asks for it follows the policy: PolicyArray and PolicyResource
+// allocations, and pinnedParallelFor() workers. The active policy comes from
+// the environment:
+//   GRAPH_NUMA=local|interleave|partition
+//   GRAPH_HUGEPAGES=off|transparent|explicit
+//   GRAPH_PIN=0|1
+// and can be replaced at run time with MemoryPolicy::setActive().
+struct MemoryPolicy
+{
+    NumaPlacement placement = NumaPlacement::local;
+    HugePages hugePages = HugePages::off;
+    // Pins pinnedParallelFor() workers to cores, spread over the nodes in worker order
+    bool pinThreads = false;
+
+    // Reads the GRAPH_* variables; an unknown value is reported on stderr and
+    // leaves that setting at its default
+    static MemoryPolicy fromEnvironment()
+    {
+        MemoryPolicy policy;
+        auto option = [](const char* name, std::initializer_list<const char*> values) {
+            const char* value = std::getenv(name);
+            if (!value || !*value) {
+                return 0;
+            }
+            int index = 0;
+            for (const char* v : values) {
+                if (std::strcmp(value, v) == 0) {
+                    return index;
+                }
+                ++index;
+            }
+            std::fprintf(stderr, "Invalid %s value '%s', using '%s'\n", name, value, *values.begin());
+            return 0;
+        };
+        policy.placement = static_cast<NumaPlacement>(option("GRAPH_NUMA", {"local", "interleave", "partition"}));
+        policy.hugePages = static_cast<HugePages>(option("GRAPH_HUGEPAGES", {"off", "transparent", "explicit"}));
+        policy.pinThreads = option("GRAPH_PIN", {"0", "1"}) == 1;
+        return policy;
+    }
+
+    static MemoryPolicy active();
+    static void setActive(const MemoryPolicy& policy);
+};
+
+namespace memory_policy_detail {
+
+struct ActivePolicy
+{
+    std::mutex mutex;
+    MemoryPolicy policy = MemoryPolicy::fromEnvironment();
+};
+
+inline ActivePolicy& activePolicy()
+{
+    static ActivePolicy state;
+    return state;
+}
+
+} // namespace memory_policy_detail
+
+inline MemoryPolicy MemoryPolicy::active()
+{
+    memory_policy_detail::ActivePolicy& state = memory_policy_detail::activePolicy();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.policy;
+}
+
+inline void MemoryPolicy::setActive(const MemoryPolicy& policy)
+{
+    memory_policy_detail::ActivePolicy& state = memory_policy_detail::activePolicy();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.policy = policy;
+}
+
+// Memory nodes and the CPUs of each this process may run on, from sysfs.
+// Machines without NUMA information look like one node holding every CPU.
+struct NumaTopology
+{
+    std::vector<int> nodes;
+    std::vector<std::vector<int>> cpus;     // cpus[i] belong to nodes[i]
+
+    static const NumaTopology& get()
+    {
+        static const NumaTopology topology = discover();
+        return topology;
+    }
+
+    // CPUs in node order, for spreading workers over the sockets
+    std::vector<int> allCpus() const
+    {
+        std::vector<int> all;
+        for (const auto& list : cpus) {
+            all.insert(all.end(), list.begin(), list.end());
+        }
+        return all;
+    }
+
+private:
+    // Parses a sysfs list such as "0-3,8,10-11"
+    static std::vector<int> parseList(const std::string& text)
+    {
+        std::vector<int> ids;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.empty() || item == "\n") {
+                continue;
+            }
+            std::size_t dash = item.find('-');
+            int lo = std::atoi(item.c_str());
+            int hi = dash == std::string::npos ? lo : std::atoi(item.c_str() + dash + 1);
+            for (int i = lo; i <= hi; ++i) {
+                ids.push_back(i);
+            }
+        }
+        return ids;
+    }
+
+    static NumaTopology discover()
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool knowAllowed = ::sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        auto usable = [&](int cpu) { return !knowAllowed || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)); };
+
+        NumaTopology topology;
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string line;
+        if (std::getline(online, line)) {
+            for (int node : parseList(line)) {
+                std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                std::string cpuLine;
+                std::getline(list, cpuLine);
+                std::vector<int> cpus;
+                for (int cpu : parseList(cpuLine)) {
+                    if (usable(cpu)) {
+                        cpus.push_back(cpu);
+                    }
+                }
+                topology.nodes.push_back(node);
+                topology.cpus.push_back(std::move(cpus));
+            }
+        }
+        if (topology.nodes.empty()) {
+            std::vector<int> cpus;
+            long count = ::sysconf(_SC_NPROCESSORS_ONLN);
+            for (int cpu = 0; cpu < count; ++cpu) {
+                if (usable(cpu)) {
+                    cpus.push_back(cpu);
+                }
+            }
+            topology.nodes.push_back(0);
+            topology.cpus.push_back(std::move(cpus));
+        }
+        return topology;
+    }
+};
+
+namespace memory_policy_detail {
+
+const std::size_t hugePageSize = std::size_t(2) << 20;
+
+// Values of <numaif.h>, spelled out so no libnuma is needed: mbind() is called
+// through syscall() and simply fails on kernels without NUMA support
+const int mpolPreferred = 1;
+const int mpolInterleave = 3;
+
+inline std::size_t roundUp(std::size_t bytes, std::size_t unit)
+{
+    return (bytes + unit - 1) / unit * unit;
+}
+
+inline bool bindPages(void* p, std::size_t bytes, int mode, const std::vector<int>& nodes)
+{
+    std::vector<unsigned long> mask(1, 0);
+    for (int node : nodes) {
+        std::size_t word = static_cast<std::size_t>(node) / (8 * sizeof(unsigned long));
+        if (word >= mask.size()) {
+            mask.resize(word + 1, 0);
+        }
+        mask[word] |= 1ul << (node % (8 * sizeof(unsigned long)));
+    }
+    const unsigned long maxNode = mask.size() * 8 * sizeof(unsigned long) + 1;
+    return ::syscall(SYS_mbind, p, bytes, mode, mask.data(), maxNode, 0) == 0;
+}
+
+} // namespace memory_policy_detail
+
+// Applies 'placement' to the pages of [p, p + bytes), which must be page
+// aligned and not yet touched: 'partition' gives node i the i-th of equal
+// page-aligned slices, preferred rather than bound so a full node spills
+// over. Returns false when the kernel refused, leaving first-touch placement.
+inline bool placePages(void* p, std::size_t bytes, NumaPlacement placement)
+{
+    using namespace memory_policy_detail;
+    const std::vector<int>& nodes = NumaTopology::get().nodes;
+    if (placement == NumaPlacement::local || nodes.size() < 2 || bytes == 0) {
+        return true;
+    }
+    if (placement == NumaPlacement::interleave) {
+        return bindPages(p, bytes, mpolInterleave, nodes);
+    }
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t parts = nodes.size();
+    bool placed = true;
+    for (std::size_t i = 0; i < parts; ++i) {
+        std::size_t lo = bytes / page * i / parts * page;
+        std::size_t hi = i + 1 == parts ? bytes : bytes / page * (i + 1) / parts * page;
+        if (hi > lo) {
+            placed &= bindPages(static_cast<char*>(p) + lo, hi - lo, mpolPreferred, {nodes[i]});
+        }
+    }
+    return placed;
+}
+
+// Memory resource that maps blocks of at least 'minMapped' bytes straight
+// from the kernel, so the policy applies to them before their first touch;
+// smaller blocks go to 'upstream'. Use it directly for arrays, or as the
+// upstream of an EdgeArena with 2 MiB chunks for adjacency rows. Thread safe.
+// The default-constructed resource follows MemoryPolicy::active() at every
+// allocation.
+class PolicyResource : public std::pmr::memory_resource
+{
+public:
+    explicit PolicyResource(std::size_t minMapped = std::size_t(1) << 20,
+                            std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : minMapped(minMapped)
+        , upstream(upstream)
+    {
+    }
+
+    PolicyResource(const MemoryPolicy& policy, std::size_t minMapped = std::size_t(1) << 20,
+                   std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : fixed(true)
+        , policy(policy)
+        , minMapped(minMapped)
+        , upstream(upstream)
+    {
+    }
+
+    ~PolicyResource() override
+    {
+        for (auto& [p, mapping] : mappings) {
+            ::munmap(p, mapping.length);
+        }
+    }
+
+    PolicyResource(const PolicyResource&) = delete;
+    PolicyResource& operator=(const PolicyResource&) = delete;
+
+    // Process-wide instance following the active policy; never destroyed, so
+    // arrays freed during static destruction still find it
+    static PolicyResource& shared()
+    {
+        static PolicyResource* resource = new PolicyResource;
+        return *resource;
+    }
+
+    // Bytes currently mapped, and counts of requests the kernel did not grant
+    struct Stats
+    {
+        std::size_t mappedBytes = 0;
+        std::size_t hugetlbBytes = 0;       // from the explicit huge page pool
+        std::size_t advisedBytes = 0;       // marked for transparent huge pages
+        std::size_t hugetlbFallbacks = 0;   // explicit requests the pool could not serve
+        std::size_t placementFailures = 0;  // mbind() refusals
+    };
+
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+
+private:
+    bool fixed = false;
+    MemoryPolicy policy;
+    std::size_t minMapped;
+    std::pmr::memory_resource* upstream;
+    mutable std::mutex mutex;
+    struct Mapping
+    {
+        std::size_t length;
+        bool hugetlb;
+        bool advised;
+    };
+    std::unordered_map<void*, Mapping> mappings;
+    Stats counters;
+
+    // Maps 'length' bytes at a 2 MiB boundary so transparent huge pages can back them
+    static void* mapAligned(std::size_t length)
+    {
+        using memory_policy_detail::hugePageSize;
+        void* raw = ::mmap(nullptr, length + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+        std::uintptr_t aligned = (start + hugePageSize - 1) / hugePageSize * hugePageSize;
+        if (aligned > start) {
+            ::munmap(raw, aligned - start);
+        }
+        std::size_t tail = start + length + hugePageSize - (aligned + length);
+        if (tail > 0) {
+            ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        using namespace memory_policy_detail;
+        if (bytes < minMapped || alignment > hugePageSize) {
+            return upstream->allocate(bytes, alignment);
+        }
+        const MemoryPolicy use = fixed ? policy : MemoryPolicy::active();
+        const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t length = roundUp(bytes, use.hugePages == HugePages::off ? page : hugePageSize);
+
+        void* p = nullptr;
+        bool hugetlb = false;
+        bool fellBack = false;
+        if (use.hugePages == HugePages::explicit_) {
+            p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            hugetlb = p != MAP_FAILED;
+            fellBack = !hugetlb;
+            p = hugetlb ? p : nullptr;
+        }
+        bool advised = false;
+        if (!p && use.hugePages != HugePages::off) {
+            p = mapAligned(length);
+            advised = p && ::madvise(p, length, MADV_HUGEPAGE) == 0;
+        } else if (!p) {
+            void* q = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            p = q == MAP_FAILED ? nullptr : q;
+        }
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        bool placed = placePages(p, length, use.placement);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        mappings[p] = Mapping {length, hugetlb, advised};
+        counters.mappedBytes += length;
+        counters.hugetlbBytes += hugetlb ? length : 0;
+        counters.advisedBytes += advised ? length : 0;
+        counters.hugetlbFallbacks += fellBack;
+        counters.placementFailures += !placed;
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        std::size_t length = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = mappings.find(p);
+            if (it != mappings.end()) {
+                const Mapping& mapping = it->second;
+                length = mapping.length;
+                counters.mappedBytes -= length;
+                counters.hugetlbBytes -= mapping.hugetlb ? length : 0;
+                counters.advisedBytes -= mapping.advised ? length : 0;
+                mappings.erase(it);
+            }
+        }
+        if (length) {
+            ::munmap(p, length);
+        } else {
+            upstream->deallocate(p, bytes, alignment);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// Standard allocator drawing on PolicyResource::shared(), for per-vertex
+// arrays of parallel algorithms; small arrays never reach mmap
+template <typename T>
+struct PolicyAllocator
+{
+    using value_type = T;
+
+    PolicyAllocator() = default;
+    template <typename U>
+    PolicyAllocator(const PolicyAllocator<U>&) {}
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(PolicyResource::shared().allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t count)
+    {
+        PolicyResource::shared().deallocate(p, count * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PolicyAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const PolicyAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using PolicyArray = std::vector<T, PolicyAllocator<T>>;
+
+// Pins the calling thread for its lifetime when 'pin' is set, restoring the
+// previous affinity afterwards. Worker w of 'workers' takes the CPU at the
+// same relative position in the node-ordered CPU list, so workers that own
+// consecutive index blocks sit on the node holding that slice of a
+// 'partition' array.
+class PinnedWorker
+{
+public:
+    PinnedWorker(unsigned worker, unsigned workers, bool pin)
+    {
+        if (!pin) {
+            return;
+        }
+        const std::vector<int> cpus = NumaTopology::get().allCpus();
+        if (cpus.empty() || ::sched_getaffinity(0, sizeof(saved), &saved) != 0) {
+            return;
+        }
+        std::size_t at = static_cast<std::size_t>(worker) * cpus.size() / (workers ? workers : 1);
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpus[at % cpus.size()], &one);
+        pinned = ::sched_setaffinity(0, sizeof(one), &one) == 0;
+    }
+
+    ~PinnedWorker()
+    {
+        if (pinned) {
+            ::sched_setaffinity(0, sizeof(saved), &saved);
+        }
+    }
+
+    PinnedWorker(const PinnedWorker&) = delete;
+    PinnedWorker& operator=(const PinnedWorker&) = delete;
+
+private:
+    cpu_set_t saved;
+    bool pinned = false;
+};
+
+// parallelForWorker() with every worker pinned when 'policy' asks for it
+template <typename F>
+void pinnedParallelForWorker(std::size_t begin, std::size_t end, F f, const MemoryPolicy& policy,
+                             unsigned threads = 0, std::size_t grain = 1)
+{
+    const bool pin = policy.pinThreads;
+    parallelForWorkerScoped(begin, end, [pin](unsigned worker, unsigned workers) {
+        return PinnedWorker(worker, workers, pin);
+    }, f, threads, grain);
+}
+
+// parallelFor() with every worker pinned when 'policy' asks for it
+template <typename F>
+void pinnedParallelFor(std::size_t begin, std::size_t end, F f, const MemoryPolicy& policy, unsigned threads = 0,
+                       std::size_t grain = 1)
+{
+    pinnedParallelForWorker(begin, end, [&f](unsigned, std::size_t i) { f(i); }, policy, threads, grain);
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "csr.hpp"
+#include "memory_policy.hpp"
+#include "parallel.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+struct PageRankOptions
+{
+    double damping = 0.85;
+    // Stops once the L1 change of the rank vector in one iteration drops below this
+    double tolerance = 1e-9;
+    int maxIterations = 100;
+    unsigned threads = 0;
+};
+
+struct PageRankResult
+{
+    std::vector<double> ranks;
+    int iterations = 0;
+    // L1 change of the last iteration
+    double residual = 0;
+    bool converged = false;
+};
+
+namespace pagerank_detail {
+
+// Sum of values[index[i]] for i in [0, count)
+inline double gatherSum(const double* values, const int* index, std::size_t count)
+{
+    std::size_t i = 0;
+    double sum = 0;
+#ifdef __AVX2__
+    // Masked gathers with an explicit zero source; GCC flags the unmasked form as uninitialized
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d acc0 = zero;
+    __m256d acc1 = zero;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(index + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(index + i + 4));
+        acc0 = _mm256_add_pd(acc0, _mm256_mask_i32gather_pd(zero, values, lo, all, 8));
+        acc1 = _mm256_add_pd(acc1, _mm256_mask_i32gather_pd(zero, values, hi, all, 8));
+    }
+    __m256d acc = _mm256_add_pd(acc0, acc1);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+#endif
+    // Independent partial sums keep the adds pipelined
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += values[index[i]];
+        s1 += values[index[i + 1]];
+        s2 += values[index[i + 2]];
+        s3 += values[index[i + 3]];
+    }
+    for (; i < count; ++i) {
+        s0 += values[index[i]];
+    }
+    return sum + ((s0 + s1) + (s2 + s3));
+}
+
+// Compact source lists of every row of 'in', tombstones dropped, in memory
+// placed by the active MemoryPolicy
+template <typename In>
+Csr<int, PolicyAllocator<int>> pullRows(int n, const In& in, unsigned threads)
+{
+    Csr<int, PolicyAllocator<int>> pull;
+    pull.offsets.assign(static_cast<std::size_t>(n) + 1, 0);
+    parallelFor(0, n, [&](std::size_t v) {
+        auto row = in[static_cast<int>(v)];
+        pull.offsets[v + 1] = static_cast<std::size_t>(std::distance(row.begin(), row.end()));
+    }, threads, 1 << 12);
+    for (int v = 0; v < n; ++v) {
+        pull.offsets[v + 1] += pull.offsets[v];
+    }
+    pull.entries.resize(pull.offsets[n]);
+    parallelFor(0, n, [&](std::size_t v) {
+        std::size_t slot = pull.offsets[v];
+        for (const auto& e : in[static_cast<int>(v)]) {
+            pull.entries[slot++] = targetOf(e);
+        }
+    }, threads, 1 << 12);
+    return pull;
+}
+
+// Splits [0, n) into 'parts' vertex ranges carrying about equal in-edges plus vertices
+template <typename Rows>
+std::vector<int> edgeBalancedBounds(const Rows& pull, unsigned parts)
+{
+    const int n = pull.rows();
+    const std::size_t total = pull.entries.size() + static_cast<std::size_t>(n);
+    std::vector<int> bounds(parts + 1, n);
+    bounds[0] = 0;
+    for (unsigned p = 1; p < parts; ++p) {
+        std::size_t goal = total * p / parts;
+        int lo = bounds[p - 1];
+        int hi = n;
+        // First v whose prefix offsets[v] + v reaches the goal
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (pull.offsets[mid] + static_cast<std::size_t>(mid) < goal) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        bounds[p] = lo;
+    }
+    return bounds;
+}
+
+} // namespace pagerank_detail
+
+// Uniform jump distribution over the vertices not flagged in 'removed'
+inline std::vector<double> uniformTeleport(const std::vector<unsigned char>& removed)
+{
+    std::vector<double> teleport(removed.size(), 0.0);
+    std::size_t live = std::count(removed.begin(), removed.end(), 0);
+    for (std::size_t v = 0; v < removed.size(); ++v) {
+        teleport[v] = removed[v] ? 0.0 : 1.0 / live;
+    }
+    return teleport;
+}
+
+// Uniform jump distribution over 'seeds'; a repeated seed counts once per occurrence
+inline std::vector<double> seedTeleport(const std::vector<unsigned char>& removed, const std::vector<int>& seeds)
+{
+    if (seeds.empty()) {
+        throw std::invalid_argument("No seed vertices!!");
+    }
+    std::vector<double> teleport(removed.size(), 0.0);
+    for (int s : seeds) {
+        if (s < 0 || static_cast<std::size_t>(s) >= removed.size()) {
+            throw std::out_of_range("Invalid vertex!!");
+        }
+        if (removed[s]) {
+            throw std::invalid_argument("Vertex is removed!!");
+        }
+        teleport[s] += 1.0 / seeds.size();
+    }
+    return teleport;
+}
+
+// Power iteration of PageRank as a pull-based SpMV: every vertex sums
+// rank / out-degree over its in-neighbors, read from 'in' (row v lists the
+// sources of the edges into v). 'teleport' is the jump distribution, summing
+// to 1; dangling vertices spread their rank along it too. Each worker owns a
+// range of vertices with about the same number of in-edges.
+template <typename In>
+PageRankResult pullPageRank(int n, const In& in, const std::vector<double>& teleport, const PageRankOptions& options)
+{
+    using namespace pagerank_detail;
+
+    PageRankResult result;
+    if (n == 0) {
+        result.converged = true;
+        return result;
+    }
+
+    const Csr<int, PolicyAllocator<int>> pull = pullRows(n, in, options.threads);
+    std::vector<std::atomic<int>> outCount(n);
+    parallelFor(0, pull.entries.size(), [&](std::size_t i) {
+        outCount[pull.entries[i]].fetch_add(1, std::memory_order_relaxed);
+    }, options.threads, 1 << 14);
+    PolicyArray<double> inverseDegree(n);
+    for (int u = 0; u < n; ++u) {
+        int degree = outCount[u].load(std::memory_order_relaxed);
+        inverseDegree[u] = degree ? 1.0 / degree : 0.0;
+    }
+
+    const unsigned workers = resolveThreads(options.threads);
+    const unsigned parts = workers * 4;
+    const std::vector<int> bounds = edgeBalancedBounds(pull, parts);
+    std::vector<double> partial(parts);
+
+    const double d = options.damping;
+    const MemoryPolicy policy = MemoryPolicy::active();
+    PolicyArray<double> rank(teleport.begin(), teleport.end());
+    PolicyArray<double> contribution(n);
+    PolicyArray<double> next(n);
+    while (result.iterations < options.maxIterations) {
+        // Share of each vertex per out-edge, and the rank held by dangling vertices
+        pinnedParallelFor(0, parts, [&](std::size_t p) {
+            double dangling = 0;
+            for (int u = bounds[p]; u < bounds[p + 1]; ++u) {
+                contribution[u] = rank[u] * inverseDegree[u];
+                dangling += inverseDegree[u] == 0.0 ? rank[u] : 0.0;
+            }
+            partial[p] = dangling;
+        }, policy, workers);
+        double dangling = 0;
+        for (double x : partial) {
+            dangling += x;
+        }
+
+        const double jump = (1.0 - d) + d * dangling;
+        pinnedParallelFor(0, parts, [&](std::size_t p) {
+            double change = 0;
+            for (int v = bounds[p]; v < bounds[p + 1]; ++v) {
+                std::size_t begin = pull.offsets[v];
+                double sum = gatherSum(contribution.data(), pull.entries.data() + begin, pull.offsets[v + 1] - begin);
+                next[v] = jump * teleport[v] + d * sum;
+                change += std::fabs(next[v] - rank[v]);
+            }
+            partial[p] = change;
+        }, policy, workers);
+        rank.swap(next);
+        ++result.iterations;
+
+        result.residual = 0;
+        for (double x : partial) {
+            result.residual += x;
+        }
+        if (result.residual < options.tolerance) {
+            result.converged = true;
+            break;
+        }
+    }
+    result.ranks.assign(rank.begin(), rank.end());
+    return result;
+}
+
+#endif
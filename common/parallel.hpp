@@ -0,0 +1,101 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Returns 'threads' or, when it is 0, the number of hardware threads
+inline unsigned resolveThreads(unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return threads == 0 ? 1 : threads;
+}
+
+// Number of workers parallelForWorker() will use for 'count' items
+inline unsigned workerCount(std::size_t count, unsigned threads = 0, std::size_t grain = 1)
+{
+    std::size_t chunks = (count + grain - 1) / grain;
+    unsigned workers = resolveThreads(threads);
+    return chunks < workers ? static_cast<unsigned>(chunks ? chunks : 1) : workers;
+}
+
+// Like parallelForWorker() below, but each worker thread first creates
+// enter(worker, workers) and holds it until it is done, e.g. to pin itself;
+// a single worker runs inline without it
+template <typename Enter, typename F>
+void parallelForWorkerScoped(std::size_t begin, std::size_t end, Enter enter, F f, unsigned threads = 0,
+                             std::size_t grain = 1)
+{
+    if (begin >= end) {
+        return;
+    }
+    unsigned workers = workerCount(end - begin, threads, grain);
+    if (workers <= 1) {
+        for (std::size_t i = begin; i < end; ++i) {
+            f(0u, i);
+        }
+        return;
+    }
+
+    // Block w is [next[w], limit[w]); cursors sit on separate cache lines
+    struct alignas(64) Cursor
+    {
+        std::atomic<std::size_t> next;
+    };
+    std::vector<Cursor> cursor(workers);
+    std::vector<std::size_t> limit(workers);
+    for (unsigned w = 0; w < workers; ++w) {
+        cursor[w].next.store(begin + (end - begin) * w / workers, std::memory_order_relaxed);
+        limit[w] = begin + (end - begin) * (w + 1) / workers;
+    }
+    auto work = [&](unsigned worker) {
+        [[maybe_unused]] auto guard = enter(worker, workers);
+        for (unsigned k = 0; k < workers; ++k) {
+            const unsigned from = (worker + k) % workers;
+            for (;;) {
+                std::size_t lo = cursor[from].next.fetch_add(grain, std::memory_order_relaxed);
+                if (lo >= limit[from]) {
+                    break;
+                }
+                std::size_t hi = lo + grain < limit[from] ? lo + grain : limit[from];
+                for (std::size_t i = lo; i < hi; ++i) {
+                    f(worker, i);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned t = 1; t < workers; ++t) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& th : pool) {
+        th.join();
+    }
+}
+
+// Runs f(worker, i) for every i in [begin, end) on up to 'threads' threads,
+// where worker is in [0, workers) and identifies the calling thread so it can
+// index per-thread scratch buffers. Worker w starts on the w-th of equal
+// blocks of the range and takes it in chunks of 'grain'; once its block is
+// done it steals chunks from the others, so uneven work still balances while
+// each worker mostly touches the same slice of per-index arrays.
+template <typename F>
+void parallelForWorker(std::size_t begin, std::size_t end, F f, unsigned threads = 0, std::size_t grain = 1)
+{
+    parallelForWorkerScoped(begin, end, [](unsigned, unsigned) { return 0; }, f, threads, grain);
+}
+
+// Runs f(i) for every i in [begin, end) on up to 'threads' threads
+template <typename F>
+void parallelFor(std::size_t begin, std::size_t end, F f, unsigned threads = 0, std::size_t grain = 1)
+{
+    parallelForWorker(begin, end, [&f](unsigned, std::size_t i) { f(i); }, threads, grain);
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PENDING_RESULT_H
+#define PENDING_RESULT_H
+
+#include <chrono>
+#include <future>
+#include <utility>
+
+// Result of one background job owned by a graph, such as a compaction.
+//
+// Copying or assigning waits for the jobs involved and leaves the target
+// idle, so a copied graph never shares or loses track of running work.
+template <typename T>
+class PendingResult
+{
+public:
+    PendingResult() = default;
+    PendingResult(const PendingResult& other) { other.wait(); }
+    PendingResult& operator=(const PendingResult& other)
+    {
+        wait();
+        other.wait();
+        job = {};
+        return *this;
+    }
+    ~PendingResult() { wait(); }
+
+    // Runs f() on a new thread; the previous job must have been taken
+    template <typename F>
+    void start(F f) { job = std::async(std::launch::async, std::move(f)); }
+
+    // Checks whether a job was started and not yet taken
+    bool running() const { return job.valid(); }
+
+    // Checks whether the job has finished
+    bool ready() const { return job.valid() && job.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+    // Blocks until the job finishes
+    void wait() const
+    {
+        if (job.valid()) {
+            job.wait();
+        }
+    }
+
+    // Waits for the job and returns its result
+    T take() { return job.get(); }
+
+private:
+    std::future<T> job;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef QUERY_ENGINE_H
+#define QUERY_ENGINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "latency.hpp"
+#include "thread_pool.hpp"
+
+// Runs batches of typed graph queries on a WorkStealingPool.
+//
+// Queries with the same Backend::groupKey() (usually the source vertex) are
+// answered together by one Backend::run() call, so a single traversal serves
+// all of them. Each worker owns one Backend::Workspace that is reused across
+// calls. Latency from submission to completion is tracked per query type.
+// An exception from run() or from a callback fails the queries of its group
+// that were not answered yet; it never reaches the pool's worker.
+//
+// Backend provides:
+//   Query, Result, Workspace           value types
+//   typeCount                          number of query types
+//   int typeOf(const Query&)           type in [0, typeCount)
+//   std::uint64_t groupKey(const Query&)
+//   void run(const std::vector<const Query*>&, std::vector<Result>&, Workspace&)
+template <typename Backend>
+class QueryEngine
+{
+public:
+    using Query = typename Backend::Query;
+    using Result = typename Backend::Result;
+    using Callback = std::function<void(std::size_t index, Result result)>;
+    using Failure = std::function<void(std::size_t index, std::exception_ptr error)>;
+
+    QueryEngine(const Backend& backend, WorkStealingPool& pool)
+        : backend(backend)
+        , pool(pool)
+        , spaces(pool.size())
+    {}
+
+    // Submits a batch; the futures follow the order of 'batch'
+    std::vector<std::future<Result>> submit(const std::vector<Query>& batch)
+    {
+        auto promises = std::make_shared<std::vector<std::promise<Result>>>(batch.size());
+        std::vector<std::future<Result>> futures;
+        futures.reserve(batch.size());
+        for (auto& p : *promises) {
+            futures.push_back(p.get_future());
+        }
+        submit(batch,
+               [promises](std::size_t i, Result r) { (*promises)[i].set_value(std::move(r)); },
+               [promises](std::size_t i, std::exception_ptr e) { (*promises)[i].set_exception(e); });
+        return futures;
+    }
+
+    // Submits a batch. Either 'done' or, when answering the query threw,
+    // 'failed' is called once per query from a worker thread; 'failed' must not throw.
+    void submit(const std::vector<Query>& batch, Callback done, Failure failed)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto queries = std::make_shared<const std::vector<Query>>(batch);
+        auto callback = std::make_shared<Callback>(std::move(done));
+        auto failure = std::make_shared<Failure>(std::move(failed));
+
+        std::unordered_map<std::uint64_t, std::vector<std::size_t>> groups;
+        for (std::size_t i = 0; i < queries->size(); ++i) {
+            groups[backend.groupKey((*queries)[i])].push_back(i);
+        }
+        for (auto& entry : groups) {
+            pool.submit([this, queries, callback, failure, start, members = std::move(entry.second)](unsigned worker) {
+                std::size_t answered = 0;
+                try {
+                    std::vector<const Query*> group;
+                    group.reserve(members.size());
+                    for (std::size_t i : members) {
+                        group.push_back(&(*queries)[i]);
+                    }
+                    std::vector<Result> results(group.size());
+                    backend.run(group, results, spaces[worker]);
+                    auto end = std::chrono::steady_clock::now();
+                    std::uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                    for (; answered < members.size(); ++answered) {
+                        latencies[backend.typeOf(*group[answered])].record(ns);
+                        (*callback)(members[answered], std::move(results[answered]));
+                    }
+                } catch (...) {
+                    // The query whose callback threw counts as failed too
+                    for (; answered < members.size(); ++answered) {
+                        (*failure)(members[answered], std::current_exception());
+                    }
+                }
+            });
+        }
+    }
+
+    // Latency of one query type, from submission to completion
+    const LatencyHistogram& latency(int type) const { return latencies[type]; }
+
+private:
+    const Backend& backend;
+    WorkStealingPool& pool;
+    std::vector<typename Backend::Workspace> spaces;
+    LatencyHistogram latencies[Backend::typeCount];
+};
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "parallel.hpp"
+
+// Fixed-size work-stealing thread pool.
+//
+// Every worker owns a deque. Tasks submitted from a worker go to its own
+// deque; others are spread round-robin. A worker pops the newest task of its
+// own deque and, when that is empty, steals the oldest task of another one.
+// Tasks receive the index of the worker running them so they can use
+// per-worker buffers. Submitting touches the sleep mutex only while some
+// worker is parked on it.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void(unsigned worker)>;
+
+    explicit WorkStealingPool(unsigned threads = 0)
+    {
+        unsigned n = resolveThreads(threads);
+        for (unsigned i = 0; i < n; ++i) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned i = 0; i < n; ++i) {
+            workers.emplace_back([this, i] { loop(i); });
+        }
+    }
+
+    // Runs every task already submitted, then joins the workers
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Number of workers
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Queues a task
+    void submit(Task task)
+    {
+        unsigned target = (currentPool == this) ? currentWorker : next.fetch_add(1) % size();
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        ++pending;
+        // A worker counts itself in 'sleepers' before it checks 'pending', so
+        // one of the two sees the other. Taking the mutex waits for a worker
+        // that saw no task to block in wait() before it is notified.
+        if (sleepers > 0) {
+            { std::lock_guard<std::mutex> lock(sleepMutex); }
+            wake.notify_one();
+        }
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<std::size_t> pending {0};   // tasks queued and not yet reserved by a worker
+    std::atomic<unsigned> sleepers {0};
+    bool stopping = false;
+    std::atomic<unsigned> next {0};
+
+    static inline thread_local WorkStealingPool* currentPool = nullptr;
+    static inline thread_local unsigned currentWorker = 0;
+
+    // Claims one of the pending tasks for the calling worker
+    bool reserve()
+    {
+        std::size_t count = pending.load();
+        while (count > 0) {
+            if (pending.compare_exchange_weak(count, count - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool tryTake(unsigned self, Task& task)
+    {
+        {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < size(); ++k) {
+            Queue& victim = *queues[(self + k) % size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void loop(unsigned self)
+    {
+        currentPool = this;
+        currentWorker = self;
+        for (;;) {
+            if (!reserve()) {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                ++sleepers;
+                wake.wait(lock, [this] { return pending > 0 || stopping; });
+                --sleepers;
+                if (stopping && pending == 0) {
+                    return;
+                }
+                continue;
+            }
+            // A task is reserved for us; another worker may still be moving it
+            Task task;
+            while (!tryTake(self, task)) {
+                std::this_thread::yield();
+            }
+            task(self);
+        }
+    }
+};
+
+#endif
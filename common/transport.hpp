@@ -0,0 +1,301 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Collective message exchange between the 'size()' ranks of a distributed run.
+// Every rank must make the same sequence of calls.
+class Transport
+{
+public:
+    virtual ~Transport() = default;
+
+    virtual int rank() const = 0;
+    virtual int size() const = 0;
+
+    // All-to-all: outgoing[r] goes to rank r and incoming[r] is what rank r sent here
+    virtual void exchange(const std::vector<std::vector<int>>& outgoing, std::vector<std::vector<int>>& incoming) = 0;
+
+    // Sum of 'value' over all ranks
+    long long allReduceSum(long long value)
+    {
+        std::vector<std::vector<int>> outgoing(size());
+        for (auto& message : outgoing) {
+            message = {static_cast<int>(value & 0xffffffff), static_cast<int>(value >> 32)};
+        }
+        std::vector<std::vector<int>> incoming;
+        exchange(outgoing, incoming);
+        long long sum = 0;
+        for (const auto& message : incoming) {
+            sum += static_cast<long long>(static_cast<std::uint32_t>(message[0])) | (static_cast<long long>(message[1]) << 32);
+        }
+        return sum;
+    }
+};
+
+// Transport over one Unix socket pair per pair of ranks, for processes on one box.
+// A round writes and reads all peers together through poll(), so large messages
+// cannot deadlock on full socket buffers.
+class SocketTransport : public Transport
+{
+public:
+    // 'peers[r]' is the socket to rank r; the entry for this rank is unused
+    SocketTransport(int rank, std::vector<int> peers) : self(rank), peers(std::move(peers))
+    {
+        for (int r = 0; r < size(); ++r) {
+            if (r != self) {
+                ::fcntl(this->peers[r], F_SETFL, ::fcntl(this->peers[r], F_GETFL) | O_NONBLOCK);
+            }
+        }
+    }
+
+    ~SocketTransport() override
+    {
+        for (int r = 0; r < size(); ++r) {
+            if (r != self) {
+                ::close(peers[r]);
+            }
+        }
+    }
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    int rank() const override { return self; }
+    int size() const override { return static_cast<int>(peers.size()); }
+
+    void exchange(const std::vector<std::vector<int>>& outgoing, std::vector<std::vector<int>>& incoming) override
+    {
+        const int n = size();
+        incoming.assign(n, {});
+        incoming[self] = outgoing[self];
+
+        // Each message is a 64-bit element count followed by the elements
+        struct Channel
+        {
+            std::uint64_t sendCount = 0;
+            std::size_t sent = 0;
+            std::uint64_t recvCount = 0;
+            std::size_t received = 0;
+        };
+        std::vector<Channel> channels(n);
+        const std::size_t header = sizeof(std::uint64_t);
+        auto sendTotal = [&](int r) { return header + outgoing[r].size() * sizeof(int); };
+        auto recvTotal = [&](int r) {
+            return channels[r].received < header ? header : header + channels[r].recvCount * sizeof(int);
+        };
+        int open = 0;
+        for (int r = 0; r < n; ++r) {
+            if (r != self) {
+                channels[r].sendCount = outgoing[r].size();
+                open += 2;
+            }
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<int> rankOf;
+        while (open > 0) {
+            fds.clear();
+            rankOf.clear();
+            for (int r = 0; r < n; ++r) {
+                if (r == self) {
+                    continue;
+                }
+                short events = 0;
+                events |= channels[r].sent < sendTotal(r) ? POLLOUT : 0;
+                events |= channels[r].received < recvTotal(r) ? POLLIN : 0;
+                if (events) {
+                    fds.push_back({peers[r], events, 0});
+                    rankOf.push_back(r);
+                }
+            }
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Transport poll failed!!");
+            }
+            for (std::size_t k = 0; k < fds.size(); ++k) {
+                const int r = rankOf[k];
+                Channel& c = channels[r];
+                if (fds[k].revents & POLLOUT) {
+                    std::size_t at = c.sent;
+                    const char* data = at < header
+                        ? reinterpret_cast<const char*>(&c.sendCount) + at
+                        : reinterpret_cast<const char*>(outgoing[r].data()) + (at - header);
+                    std::size_t len = at < header ? header - at : sendTotal(r) - at;
+                    ssize_t put = ::send(peers[r], data, len, MSG_NOSIGNAL);
+                    if (put < 0 && errno != EAGAIN && errno != EINTR) {
+                        throw std::runtime_error("Transport send failed!!");
+                    }
+                    c.sent += put > 0 ? static_cast<std::size_t>(put) : 0;
+                    open -= c.sent == sendTotal(r);
+                }
+                if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    std::size_t at = c.received;
+                    char* data = at < header
+                        ? reinterpret_cast<char*>(&c.recvCount) + at
+                        : reinterpret_cast<char*>(incoming[r].data()) + (at - header);
+                    std::size_t len = recvTotal(r) - at;
+                    ssize_t got = ::recv(peers[r], data, len, 0);
+                    if (got == 0) {
+                        throw std::runtime_error("Transport peer closed!!");
+                    }
+                    if (got < 0 && errno != EAGAIN && errno != EINTR) {
+                        throw std::runtime_error("Transport receive failed!!");
+                    }
+                    c.received += got > 0 ? static_cast<std::size_t>(got) : 0;
+                    if (at < header && c.received == header) {
+                        incoming[r].resize(c.recvCount);
+                    }
+                    open -= c.received == recvTotal(r) && c.received >= header;
+                }
+            }
+        }
+    }
+
+private:
+    int self;
+    std::vector<int> peers;
+};
+
+// Ranks 1.. of a distributed run as child processes, joined to the caller,
+// rank 0, by a SocketTransport. The children are forked once, when the group
+// is created, and then wait for run() calls. Create the group before the
+// process starts any thread (thread pools, parallelFor): a child only keeps
+// the forking thread, and a lock another thread held at the fork, such as
+// one inside malloc, would stay locked in it forever.
+class ProcessGroup
+{
+public:
+    // Forks 'processes' - 1 children; each runs serve(transport) once per run()
+    ProcessGroup(int processes, std::function<void(Transport&)> serve)
+    {
+        if (processes < 1) {
+            throw std::invalid_argument("Invalid process count!!");
+        }
+        // sockets[i][j] is rank i's end of the pair shared with rank j
+        std::vector<std::vector<int>> sockets(processes, std::vector<int>(processes, -1));
+        auto closeAllBut = [&](int keep) {
+            for (int i = 0; i < processes; ++i) {
+                for (int j = 0; j < processes; ++j) {
+                    if (i != keep && sockets[i][j] >= 0) {
+                        ::close(sockets[i][j]);
+                    }
+                }
+            }
+        };
+        for (int i = 0; i < processes; ++i) {
+            for (int j = i + 1; j < processes; ++j) {
+                int pair[2];
+                if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+                    closeAllBut(-1);
+                    throw std::runtime_error("Cannot create socket pair!!");
+                }
+                sockets[i][j] = pair[0];
+                sockets[j][i] = pair[1];
+            }
+        }
+
+        for (int r = 1; r < processes; ++r) {
+            pid_t pid = ::fork();
+            if (pid == 0) {
+                closeAllBut(r);
+                ::_exit(serveJobs(r, sockets[r], serve));
+            }
+            if (pid < 0) {
+                // Closing our ends makes the children already started exit
+                closeAllBut(-1);
+                waitChildren();
+                throw std::runtime_error("Cannot fork!!");
+            }
+            children.push_back(pid);
+        }
+        closeAllBut(0);
+        transport = std::make_unique<SocketTransport>(0, sockets[0]);
+    }
+
+    // Stops the children and waits for them
+    ~ProcessGroup()
+    {
+        if (!broken) {
+            try {
+                std::vector<std::vector<int>> stop(size()), incoming;
+                transport->exchange(stop, incoming);
+            } catch (...) {
+            }
+        }
+        transport.reset();
+        waitChildren();
+    }
+
+    ProcessGroup(const ProcessGroup&) = delete;
+    ProcessGroup& operator=(const ProcessGroup&) = delete;
+
+    int size() const { return transport->size(); }
+
+    // Runs body(transport) as rank 0 while every child runs its serve().
+    // Rethrows what body throws; a child that fails makes rank 0's next
+    // exchange throw. Either way the ranks are out of step afterwards, so
+    // later calls throw too.
+    void run(const std::function<void(Transport&)>& body)
+    {
+        if (broken) {
+            throw std::runtime_error("Worker process failed!!");
+        }
+        try {
+            std::vector<std::vector<int>> start(size(), std::vector<int> {1}), incoming;
+            transport->exchange(start, incoming);
+            body(*transport);
+        } catch (...) {
+            broken = true;
+            throw;
+        }
+    }
+
+private:
+    std::unique_ptr<SocketTransport> transport;
+    std::vector<pid_t> children;
+    bool broken = false;
+
+    // Loop of child 'rank': serve() for every start message from rank 0, until
+    // an empty one; returns the exit status
+    static int serveJobs(int rank, const std::vector<int>& peers, const std::function<void(Transport&)>& serve)
+    {
+        try {
+            SocketTransport transport(rank, peers);
+            std::vector<std::vector<int>> none(transport.size()), incoming;
+            for (;;) {
+                transport.exchange(none, incoming);
+                if (incoming[0].empty()) {
+                    return 0;
+                }
+                serve(transport);
+            }
+        } catch (...) {
+            return 1;
+        }
+    }
+
+    void waitChildren()
+    {
+        for (pid_t child : children) {
+            ::waitpid(child, nullptr, 0);
+        }
+        children.clear();
+    }
+};
+
+#endif
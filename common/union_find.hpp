@@ -0,0 +1,66 @@
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Lock-free disjoint sets over [0, n), safe for concurrent find() and unite().
+// Roots always link under the smaller root id, so no cycle can form, and
+// find() halves paths with compare-and-swap as it walks.
+class ConcurrentUnionFind
+{
+public:
+    explicit ConcurrentUnionFind(int n) : parent(n)
+    {
+        for (int i = 0; i < n; ++i) {
+            parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    int size() const { return static_cast<int>(parent.size()); }
+
+    // Returns the current root of x
+    int find(int x)
+    {
+        for (;;) {
+            int p = parent[x].load(std::memory_order_acquire);
+            if (p == x) {
+                return x;
+            }
+            int gp = parent[p].load(std::memory_order_acquire);
+            if (p != gp) {
+                parent[x].compare_exchange_weak(p, gp, std::memory_order_acq_rel);
+            }
+            x = gp;
+        }
+    }
+
+    // Merges the sets of a and b; false when they already were one set
+    bool unite(int a, int b)
+    {
+        for (;;) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return false;
+            }
+            if (a < b) {
+                std::swap(a, b);
+            }
+            int expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+    }
+
+    // Checks whether a and b are in one set; exact while no unite() runs
+    bool same(int a, int b) { return find(a) == find(b); }
+
+private:
+    std::vector<std::atomic<int>> parent;
+};
+
+#endif
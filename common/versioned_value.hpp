@@ -0,0 +1,81 @@
+#ifndef VERSIONED_VALUE_H
+#define VERSIONED_VALUE_H
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+// One memoized query result, valid for a single graph version.
+//
+// get() serves the stored value while the caller's version matches and
+// recomputes it otherwise. Any number of readers may call get() at once;
+// the value is copied out under a shared lock. Copies of a graph start with
+// a cold cache, so copying or assigning never shares results.
+template <typename T>
+class VersionedValue
+{
+public:
+    VersionedValue() = default;
+    VersionedValue(const VersionedValue&) {}
+    VersionedValue& operator=(const VersionedValue&)
+    {
+        clear();
+        return *this;
+    }
+
+    // Returns the value for 'version', calling compute() on a miss
+    template <typename F>
+    T get(std::uint64_t version, F compute) const
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            if (valid && stored == version) {
+                return value;
+            }
+        }
+        T fresh = compute();
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (!valid || stored != version) {
+            value = fresh;
+            stored = version;
+            valid = true;
+        }
+        return fresh;
+    }
+
+    // Copies the stored value into 'out' when it is valid for 'version'
+    bool peek(std::uint64_t version, T& out) const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        if (valid && stored == version) {
+            out = value;
+            return true;
+        }
+        return false;
+    }
+
+    // Stores 'fresh' as the value for 'version', e.g. when restoring a snapshot
+    void put(std::uint64_t version, T fresh)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        value = std::move(fresh);
+        stored = version;
+        valid = true;
+    }
+
+    // Drops the stored value
+    void clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        valid = false;
+    }
+
+private:
+    mutable std::shared_mutex mutex;
+    mutable bool valid = false;
+    mutable std::uint64_t stored = 0;
+    mutable T value {};
+};
+
+#endif
@@ -0,0 +1,23 @@
+#include "dijkstra_queries.h"
+#include "wgraph.h"
+
+DijkstraQueries::DijkstraQueries(const Graph& graph)
+    : graph(graph)
+{}
+
+void DijkstraQueries::run(const std::vector<const Query*>& group, std::vector<Result>& results, Workspace& ws) const
+{
+    std::vector<int> targets;
+    targets.reserve(group.size());
+    for (const Query* q : group) {
+        targets.push_back(q->target);
+    }
+    DijkstraSearch search(graph, ws, group.front()->source, targets);
+    search.run();
+    for (std::size_t k = 0; k < group.size(); ++k) {
+        if (search.settled(targets[k])) {
+            results[k].distance = search.distance(targets[k]);
+            results[k].path = search.path(targets[k]);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef DIJKSTRA_QUERIES_H
+#define DIJKSTRA_QUERIES_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "shortest_paths.h"
+
+class Graph;
+
+// QueryEngine backend for weighted Graph distance queries. Queries are
+// grouped by source and one DijkstraSearch stops as soon as all of the
+// group's targets are settled.
+class DijkstraQueries
+{
+public:
+    enum Type { Distance, typeCount };
+
+    static constexpr double unreachable = std::numeric_limits<double>::infinity();
+
+    struct Query
+    {
+        int source;
+        int target;
+    };
+
+    struct Result
+    {
+        double distance = unreachable;
+        std::vector<int> path;      // empty when unreachable
+    };
+
+    // Per-worker Dijkstra buffers, reused across queries
+    using Workspace = DijkstraWorkspace;
+
+    explicit DijkstraQueries(const Graph& graph);
+
+    static int typeOf(const Query&) { return Distance; }
+    std::uint64_t groupKey(const Query& q) const { return static_cast<std::uint64_t>(q.source); }
+
+    // Answers a group of queries that share one source
+    void run(const std::vector<const Query*>& group, std::vector<Result>& results, Workspace& ws) const;
+
+private:
+    const Graph& graph;
+};
+
+#endif  // DIJKSTRA_QUERIES_H
@@ -0,0 +1,226 @@
+#ifndef EDGE_WEIGHTS_H
+#define EDGE_WEIGHTS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../../common/csr.hpp"
+
+// How edge weights are stored; every type is read back as double
+enum class WeightType : std::uint8_t
+{
+    float64,
+    float32,
+    uint16Quantized,    // round(weight / scale) in [0, 65535]
+    int32,              // integral weights only
+};
+
+struct WeightFormat
+{
+    WeightType type = WeightType::float64;
+    double scale = 1.0;     // step of uint16Quantized
+
+    std::size_t bytes() const
+    {
+        switch (type) {
+        case WeightType::float64: return sizeof(double);
+        case WeightType::float32: return sizeof(float);
+        case WeightType::uint16Quantized: return sizeof(std::uint16_t);
+        case WeightType::int32: return sizeof(std::int32_t);
+        }
+        return 0;
+    }
+
+    // Writes 'weight' at 'out'; throws std::invalid_argument when this type cannot
+    // hold it. NaN is never accepted, since no path order could hold it.
+    void encode(double weight, unsigned char* out) const
+    {
+        if (std::isnan(weight)) {
+            throw std::invalid_argument("Weight is not representable!!");
+        }
+        switch (type) {
+        case WeightType::float64:
+            std::memcpy(out, &weight, sizeof(double));
+            return;
+        case WeightType::float32: {
+            float w = static_cast<float>(weight);
+            if (std::isinf(w) && !std::isinf(weight)) {
+                break;
+            }
+            std::memcpy(out, &w, sizeof(float));
+            return;
+        }
+        case WeightType::uint16Quantized: {
+            double q = std::nearbyint(weight / scale);
+            if (!(q >= 0 && q <= 65535)) {
+                break;
+            }
+            std::uint16_t w = static_cast<std::uint16_t>(q);
+            std::memcpy(out, &w, sizeof(w));
+            return;
+        }
+        case WeightType::int32: {
+            if (!(weight >= INT32_MIN && weight <= INT32_MAX) || weight != std::trunc(weight)) {
+                break;
+            }
+            std::int32_t w = static_cast<std::int32_t>(weight);
+            std::memcpy(out, &w, sizeof(w));
+            return;
+        }
+        }
+        throw std::invalid_argument("Weight is not representable!!");
+    }
+
+    double decode(const unsigned char* in) const
+    {
+        switch (type) {
+        case WeightType::float64: {
+            double w;
+            std::memcpy(&w, in, sizeof(w));
+            return w;
+        }
+        case WeightType::float32: {
+            float w;
+            std::memcpy(&w, in, sizeof(w));
+            return w;
+        }
+        case WeightType::uint16Quantized: {
+            std::uint16_t w;
+            std::memcpy(&w, in, sizeof(w));
+            return w * scale;
+        }
+        case WeightType::int32: {
+            std::int32_t w;
+            std::memcpy(&w, in, sizeof(w));
+            return w;
+        }
+        }
+        return 0;
+    }
+};
+
+// Read-only view of one adjacency row kept as two parallel arrays: targets,
+// and weights encoded in 'format'. Iteration yields {target, weight} pairs by
+// value and skips tombstones like NeighborRange; targets() walks the targets
+// alone, for scans that never read a weight. size() and operator[] address
+// the raw slots, tombstones included.
+class WeightedNeighbors
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<int, double>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        iterator() = default;
+        iterator(NeighborRange<int>::iterator at, const int* first, const unsigned char* weights, WeightFormat format)
+            : at(at), first(first), weights(weights), format(format) {}
+
+        value_type operator*() const
+        {
+            const int* p = &*at;
+            return {*p, format.decode(weights + static_cast<std::size_t>(p - first) * format.bytes())};
+        }
+        iterator& operator++() { ++at; return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++at; return tmp; }
+        bool operator==(const iterator& other) const { return at == other.at; }
+        bool operator!=(const iterator& other) const { return at != other.at; }
+
+    private:
+        NeighborRange<int>::iterator at;
+        const int* first = nullptr;
+        const unsigned char* weights = nullptr;
+        WeightFormat format;
+    };
+
+    WeightedNeighbors() = default;
+    WeightedNeighbors(const int* first, const int* last, const unsigned char* weights, WeightFormat format,
+                      const unsigned char* removed = nullptr)
+        : first(first), last(last), weights(weights), format(format), removed(removed) {}
+
+    NeighborRange<int> targets() const { return {first, last, removed}; }
+    iterator begin() const { return iterator(targets().begin(), first, weights, format); }
+    iterator end() const { return iterator(targets().end(), first, weights, format); }
+    std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    bool empty() const { return begin() == end(); }
+    std::pair<int, double> operator[](std::size_t i) const { return {first[i], weight(i)}; }
+    int target(std::size_t i) const { return first[i]; }
+    double weight(std::size_t i) const { return format.decode(weights + i * format.bytes()); }
+
+    // Calls f(target, encoded weight) for every live slot, without decoding
+    template <typename F>
+    void forEachEncoded(F f) const
+    {
+        const std::size_t bytes = format.bytes();
+        for (auto it = targets().begin(); it != targets().end(); ++it) {
+            const int* p = &*it;
+            f(*p, weights + static_cast<std::size_t>(p - first) * bytes);
+        }
+    }
+
+private:
+    const int* first = nullptr;
+    const int* last = nullptr;
+    const unsigned char* weights = nullptr;
+    WeightFormat format;
+    const unsigned char* removed = nullptr;
+};
+
+// Compressed rows of weighted edges, targets and encoded weights apart
+struct WeightedCsr
+{
+    WeightFormat format;
+    std::vector<std::size_t> offsets;
+    std::vector<int> targets;
+    std::vector<unsigned char> weights;
+
+    int rows() const { return offsets.empty() ? 0 : static_cast<int>(offsets.size() - 1); }
+
+    WeightedNeighbors row(int u, const unsigned char* removed = nullptr) const
+    {
+        return {targets.data() + offsets[u], targets.data() + offsets[u + 1],
+                weights.data() + offsets[u] * format.bytes(), format, removed};
+    }
+};
+
+// One vertex's out-edges, allocator-aware so the rows of a std::pmr::vector
+// draw from the graph's memory resource
+struct WeightedRow
+{
+    using allocator_type = std::pmr::polymorphic_allocator<int>;
+
+    std::pmr::vector<int> targets;
+    std::pmr::vector<unsigned char> weights;
+
+    WeightedRow() = default;
+    explicit WeightedRow(const allocator_type& alloc) : targets(alloc), weights(alloc) {}
+    WeightedRow(const WeightedRow& other, const allocator_type& alloc)
+        : targets(other.targets, alloc), weights(other.weights, alloc) {}
+    WeightedRow(WeightedRow&& other, const allocator_type& alloc)
+        : targets(std::move(other.targets), alloc), weights(std::move(other.weights), alloc) {}
+    WeightedRow(const WeightedRow&) = default;
+    WeightedRow(WeightedRow&&) = default;
+    WeightedRow& operator=(const WeightedRow&) = default;
+    WeightedRow& operator=(WeightedRow&&) = default;
+
+    std::size_t size() const { return targets.size(); }
+
+    // Appends an edge whose weight is already encoded in 'bytes' bytes
+    void push(int target, const unsigned char* weight, std::size_t bytes)
+    {
+        weights.insert(weights.end(), weight, weight + bytes);
+        targets.push_back(target);
+    }
+};
+
+#endif  // EDGE_WEIGHTS_H
@@ -0,0 +1,153 @@
+#include "johnson.h"
+#include "wgraph.h"
+#include "../../common/parallel.hpp"
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+TiledDistanceMatrix::TiledDistanceMatrix(int n)
+    : DistanceStore(n)
+    , tilesPerRow((n + tileSize - 1) / tileSize)
+    , data(std::size_t(tilesPerRow) * tilesPerRow * tileSize * tileSize, unreachable)
+{}
+
+void TiledDistanceMatrix::writeRow(int src, const std::vector<double>& row)
+{
+    const std::size_t tileRow = std::size_t(src / tileSize) * tilesPerRow;
+    const int r = src % tileSize;
+    for (int t = 0; t < tilesPerRow; ++t) {
+        double* dst = &data[((tileRow + t) * tileSize + r) * tileSize];
+        int j0 = t * tileSize;
+        int len = std::min(tileSize, n - j0);
+        std::memcpy(dst, row.data() + j0, len * sizeof(double));
+    }
+}
+
+double TiledDistanceMatrix::at(int i, int j) const
+{
+    std::size_t tile = std::size_t(i / tileSize) * tilesPerRow + j / tileSize;
+    return data[(tile * tileSize + i % tileSize) * tileSize + j % tileSize];
+}
+
+MappedDistanceFile::MappedDistanceFile(int n, const std::string& path)
+    : DistanceStore(n)
+    , fd(-1)
+    , bytes(std::size_t(n) * n * sizeof(double))
+    , map(nullptr)
+{
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    if (bytes == 0) {
+        return;
+    }
+    if (::ftruncate(fd, bytes) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot resize " + path);
+    }
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map " + path);
+    }
+    map = static_cast<double*>(p);
+}
+
+MappedDistanceFile::~MappedDistanceFile()
+{
+    if (map) {
+        ::msync(map, bytes, MS_SYNC);
+        ::munmap(map, bytes);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void MappedDistanceFile::writeRow(int src, const std::vector<double>& row)
+{
+    double* dst = map + std::size_t(src) * n;
+    std::memcpy(dst, row.data(), n * sizeof(double));
+
+    // Start write-back of the finished row so its pages become reclaimable
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t begin = std::size_t(src) * n * sizeof(double) / page * page;
+    std::size_t end = std::size_t(src + 1) * n * sizeof(double);
+    ::msync(reinterpret_cast<char*>(map) + begin, end - begin, MS_ASYNC);
+}
+
+double MappedDistanceFile::at(int i, int j) const
+{
+    return map[std::size_t(i) * n + j];
+}
+
+std::vector<double> johnsonPotentials(const Graph& graph)
+{
+    const int n = graph.size();
+    std::vector<double> h(n, 0);
+    bool negative = false;
+    for (int u = 0; u < n && !negative; ++u) {
+        for (const auto& e : graph.neighbors(u)) {
+            negative = negative || e.second < 0;
+        }
+    }
+    if (!negative) {
+        return h;
+    }
+
+    // Bellman-Ford from a virtual source joined to every vertex by a 0 edge.
+    // weight + h[u] is the sum DijkstraSearch forms, so once nothing relaxes
+    // every reweighted edge weight + h[u] - h[v] is at least 0 in doubles too.
+    for (int round = 0; round <= n; ++round) {
+        bool changed = false;
+        for (int u = 0; u < n; ++u) {
+            for (const auto& [v, weight] : graph.neighbors(u)) {
+                if (weight + h[u] < h[v]) {
+                    h[v] = weight + h[u];
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) {
+            return h;
+        }
+    }
+    throw std::runtime_error("Negative cycle!!");
+}
+
+void allPairsJohnson(const Graph& graph, DistanceStore& out, unsigned threads)
+{
+    const int n = graph.size();
+    const std::vector<double> h = johnsonPotentials(graph);
+    std::vector<DijkstraWorkspace> spaces(workerCount(n, threads));
+    std::vector<std::vector<double>> rows(spaces.size(), std::vector<double>(n));
+
+    parallelForWorker(0, n, [&](unsigned worker, std::size_t s) {
+        std::vector<double>& row = rows[worker];
+        int src = static_cast<int>(s);
+        DijkstraSearch search(graph, spaces[worker], src, {}, {}, &h);
+        search.run();
+        std::fill(row.begin(), row.end(), DistanceStore::unreachable);
+        for (int v : search.touched()) {
+            row[v] = search.distance(v) - h[src] + h[v];
+        }
+        out.writeRow(src, row);
+    }, threads);
+}
+
+std::unique_ptr<DistanceStore> allPairsJohnson(const Graph& graph, const JohnsonOptions& options)
+{
+    const std::size_t n = graph.size();
+    std::unique_ptr<DistanceStore> out;
+    if (n * n * sizeof(double) <= options.memoryBudget) {
+        out = std::make_unique<TiledDistanceMatrix>(graph.size());
+    } else {
+        out = std::make_unique<MappedDistanceFile>(graph.size(), options.spillPath);
+    }
+    allPairsJohnson(graph, *out, options.threads);
+    return out;
+}
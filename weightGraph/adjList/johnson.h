@@ -0,0 +1,85 @@
+#ifndef JOHNSON_H
+#define JOHNSON_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Graph;
+
+// Destination for the rows of an all-pairs result.
+// writeRow() is called concurrently for different sources.
+class DistanceStore
+{
+public:
+    // Distance stored for "no path"
+    static constexpr double unreachable = std::numeric_limits<double>::infinity();
+
+    explicit DistanceStore(int n) : n(n) {}
+    virtual ~DistanceStore() = default;
+
+    int size() const { return n; }
+    virtual void writeRow(int src, const std::vector<double>& row) = 0;
+    virtual double at(int i, int j) const = 0;
+
+protected:
+    int n;
+};
+
+// In-memory result stored as 64x64 tiles so row and column blocks stay local
+class TiledDistanceMatrix : public DistanceStore
+{
+public:
+    static constexpr int tileSize = 64;
+
+    explicit TiledDistanceMatrix(int n);
+    void writeRow(int src, const std::vector<double>& row) override;
+    double at(int i, int j) const override;
+
+private:
+    int tilesPerRow;
+    std::vector<double> data;
+};
+
+// Row-major result in a memory-mapped file, for results larger than RAM.
+// Finished rows are handed back to the kernel as they are written.
+class MappedDistanceFile : public DistanceStore
+{
+public:
+    MappedDistanceFile(int n, const std::string& path);
+    ~MappedDistanceFile() override;
+    MappedDistanceFile(const MappedDistanceFile&) = delete;
+    MappedDistanceFile& operator=(const MappedDistanceFile&) = delete;
+
+    void writeRow(int src, const std::vector<double>& row) override;
+    double at(int i, int j) const override;
+
+private:
+    int fd;
+    std::size_t bytes;
+    double* map;
+};
+
+struct JohnsonOptions
+{
+    unsigned threads = 0;                       // 0 uses every hardware thread
+    std::size_t memoryBudget = std::size_t(1) << 30;  // largest result kept in RAM
+    std::string spillPath = "apsp.bin";         // file used beyond the budget
+};
+
+// Bellman-Ford potentials that make every edge weight non-negative.
+// All zeros when there are no negative edges; throws on a negative cycle.
+// They relax the same double sums the reweighted searches form, so no
+// reweighted edge rounds below zero.
+std::vector<double> johnsonPotentials(const Graph& graph);
+
+// Johnson's all-pairs shortest paths written row by row into 'out'
+void allPairsJohnson(const Graph& graph, DistanceStore& out, unsigned threads = 0);
+
+// Johnson's all-pairs shortest paths into a tiled matrix, or a mapped file
+// when n * n distances exceed options.memoryBudget
+std::unique_ptr<DistanceStore> allPairsJohnson(const Graph& graph, const JohnsonOptions& options = {});
+
+#endif  // JOHNSON_H
@@ -47,7 +47,7 @@ int main() {
     std::cout << std::endl;
 
     // Find the shortest path between vertices 2 and 3
-    int shortestPath = g.ShortestPath(2, 3);
+    double shortestPath = g.ShortestPath(2, 3);
     std::cout << "Shortest path from 2 to 3: " << shortestPath << std::endl;
     std::cout << std::endl;
 
@@ -0,0 +1,190 @@
+#include "mst.h"
+#include "wgraph.h"
+#include "../../common/parallel.hpp"
+#include "../../common/union_find.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+const std::size_t grain = 1 << 14;
+
+// Every stored edge slot as {u, v, weight}, self loops dropped
+std::vector<ForestEdge> collectEdges(const Graph& graph, unsigned threads)
+{
+    const int n = graph.size();
+    std::vector<std::size_t> offsets(n + 1, 0);
+    parallelFor(0, n, [&](std::size_t u) {
+        std::size_t count = 0;
+        for (int v : graph.neighbors(u).targets()) {
+            count += v != static_cast<int>(u);
+        }
+        offsets[u + 1] = count;
+    }, threads, grain);
+    for (int u = 0; u < n; ++u) {
+        offsets[u + 1] += offsets[u];
+    }
+    std::vector<ForestEdge> edges(offsets[n]);
+    parallelFor(0, n, [&](std::size_t u) {
+        std::size_t slot = offsets[u];
+        for (const auto& [v, w] : graph.neighbors(u)) {
+            if (v != static_cast<int>(u)) {
+                edges[slot++] = {static_cast<int>(u), v, w};
+            }
+        }
+    }, threads, grain);
+    return edges;
+}
+
+// Stable parallel copy of the edges that satisfy keep()
+template <typename Keep>
+std::vector<ForestEdge> filterEdges(const std::vector<ForestEdge>& edges, Keep keep, unsigned threads)
+{
+    const std::size_t blocks = (edges.size() + grain - 1) / grain;
+    std::vector<std::size_t> offsets(blocks + 1, 0);
+    parallelFor(0, blocks, [&](std::size_t b) {
+        std::size_t end = std::min(edges.size(), (b + 1) * grain);
+        std::size_t count = 0;
+        for (std::size_t i = b * grain; i < end; ++i) {
+            count += keep(edges[i]);
+        }
+        offsets[b + 1] = count;
+    }, threads);
+    for (std::size_t b = 0; b < blocks; ++b) {
+        offsets[b + 1] += offsets[b];
+    }
+    std::vector<ForestEdge> kept(offsets[blocks]);
+    parallelFor(0, blocks, [&](std::size_t b) {
+        std::size_t end = std::min(edges.size(), (b + 1) * grain);
+        std::size_t slot = offsets[b];
+        for (std::size_t i = b * grain; i < end; ++i) {
+            if (keep(edges[i])) {
+                kept[slot++] = edges[i];
+            }
+        }
+    }, threads);
+    return kept;
+}
+
+// Orders edges by weight, then by position, so no two edges compare equal
+bool lighter(const std::vector<ForestEdge>& edges, std::uint64_t a, std::uint64_t b)
+{
+    return edges[a].weight < edges[b].weight || (edges[a].weight == edges[b].weight && a < b);
+}
+
+void addToForest(SpanningForest& forest, const ForestEdge& e)
+{
+    forest.edges.push_back(e);
+    forest.totalWeight += e.weight;
+}
+
+// Sequential Kruskal on a slice of edges, sharing the caller's union-find
+void kruskal(std::vector<ForestEdge>& edges, ConcurrentUnionFind& sets, SpanningForest& forest)
+{
+    std::sort(edges.begin(), edges.end(), [](const ForestEdge& a, const ForestEdge& b) { return a.weight < b.weight; });
+    for (const ForestEdge& e : edges) {
+        if (sets.unite(e.u, e.v)) {
+            addToForest(forest, e);
+        }
+    }
+}
+
+void filterKruskal(std::vector<ForestEdge>& edges, ConcurrentUnionFind& sets, SpanningForest& forest, unsigned threads)
+{
+    if (edges.size() <= 4 * grain) {
+        kruskal(edges, sets, forest);
+        return;
+    }
+    // Median of three spread samples as the pivot weight
+    double a = edges[0].weight;
+    double b = edges[edges.size() / 2].weight;
+    double c = edges.back().weight;
+    double pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+    std::vector<ForestEdge> light = filterEdges(edges, [&](const ForestEdge& e) { return e.weight <= pivot; }, threads);
+    if (light.size() == edges.size()) {
+        // No heavy side to split off, e.g. equal weights
+        kruskal(edges, sets, forest);
+        return;
+    }
+    std::vector<ForestEdge> heavy = filterEdges(edges, [&](const ForestEdge& e) { return e.weight > pivot; }, threads);
+    std::vector<ForestEdge>().swap(edges);
+
+    filterKruskal(light, sets, forest, threads);
+    std::vector<ForestEdge>().swap(light);
+    heavy = filterEdges(heavy, [&](const ForestEdge& e) { return !sets.same(e.u, e.v); }, threads);
+    filterKruskal(heavy, sets, forest, threads);
+}
+
+}
+
+SpanningForest boruvkaForest(const Graph& graph, unsigned threads)
+{
+    const int n = graph.size();
+    std::vector<ForestEdge> edges = collectEdges(graph, threads);
+
+    ConcurrentUnionFind sets(n);
+    const std::uint64_t none = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::atomic<std::uint64_t>> best(n);
+    parallelFor(0, n, [&](std::size_t v) { best[v].store(none, std::memory_order_relaxed); }, threads, grain);
+
+    unsigned workers = workerCount(n, threads, grain);
+    std::vector<SpanningForest> found(workers);
+    while (!edges.empty()) {
+        // Lightest edge leaving every component
+        parallelFor(0, edges.size(), [&](std::size_t i) {
+            for (int root : {sets.find(edges[i].u), sets.find(edges[i].v)}) {
+                std::uint64_t current = best[root].load(std::memory_order_relaxed);
+                while ((current == none || lighter(edges, i, current))
+                       && !best[root].compare_exchange_weak(current, i, std::memory_order_relaxed)) {
+                }
+            }
+        }, threads, grain);
+
+        // Hook each component along its edge; the strict (weight, index) order rules out cycles
+        parallelForWorker(0, n, [&](unsigned worker, std::size_t v) {
+            std::uint64_t index = best[v].load(std::memory_order_relaxed);
+            if (index == none) {
+                return;
+            }
+            best[v].store(none, std::memory_order_relaxed);
+            const ForestEdge& e = edges[index];
+            if (sets.unite(e.u, e.v)) {
+                addToForest(found[worker], e);
+            }
+        }, workers, grain);
+
+        edges = filterEdges(edges, [&](const ForestEdge& e) { return !sets.same(e.u, e.v); }, threads);
+    }
+
+    SpanningForest forest;
+    for (SpanningForest& part : found) {
+        forest.edges.insert(forest.edges.end(), part.edges.begin(), part.edges.end());
+        forest.totalWeight += part.totalWeight;
+    }
+    return forest;
+}
+
+SpanningForest filterKruskalForest(const Graph& graph, unsigned threads)
+{
+    std::vector<ForestEdge> edges = collectEdges(graph, threads);
+    ConcurrentUnionFind sets(graph.size());
+    SpanningForest forest;
+    filterKruskal(edges, sets, forest, threads);
+    return forest;
+}
+
+SpanningForest minimumSpanningForest(const Graph& graph, unsigned threads)
+{
+    std::size_t slots = 0;
+    for (int u = 0; u < graph.size(); ++u) {
+        slots += graph.neighbors(u).size();
+    }
+    if (slots <= 8 * static_cast<std::size_t>(graph.size())) {
+        return filterKruskalForest(graph, threads);
+    }
+    return boruvkaForest(graph, threads);
+}
@@ -0,0 +1,34 @@
+#ifndef MST_H
+#define MST_H
+
+#include <vector>
+
+class Graph;
+
+struct ForestEdge
+{
+    int u;
+    int v;
+    double weight;
+};
+
+struct SpanningForest
+{
+    std::vector<ForestEdge> edges;
+    double totalWeight = 0;
+};
+
+// Minimum spanning forest by parallel Boruvka rounds over a concurrent
+// union-find. Every stored edge counts as undirected, including those added
+// with addDirectedEdge; self loops are ignored.
+SpanningForest boruvkaForest(const Graph& graph, unsigned threads = 0);
+
+// Minimum spanning forest by filter-Kruskal: partitions around a pivot
+// weight, solves the light half, then drops heavy edges that would close a
+// cycle before recursing. Partitions and filters run in parallel.
+SpanningForest filterKruskalForest(const Graph& graph, unsigned threads = 0);
+
+// Filter-Kruskal for sparse graphs, Boruvka otherwise
+SpanningForest minimumSpanningForest(const Graph& graph, unsigned threads = 0);
+
+#endif  // MST_H
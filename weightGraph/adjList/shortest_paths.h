@@ -0,0 +1,142 @@
+#ifndef SHORTEST_PATHS_H
+#define SHORTEST_PATHS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "../../common/memory_policy.hpp"
+
+class Graph;
+
+struct ShortestPathOptions
+{
+    // Vertices farther than this from the source are never settled
+    double maxDistance = std::numeric_limits<double>::infinity();
+};
+
+struct DagPathOptions
+{
+    // Longest (critical) paths instead of shortest ones
+    bool longest = false;
+    unsigned threads = 0;
+};
+
+enum class BellmanFordMethod : unsigned char
+{
+    frontier,   // parallel rounds over the vertices that changed in the last round
+    spfa,       // sequential queue with the SLF and LLL heuristics
+};
+
+struct BellmanFordOptions
+{
+    BellmanFordMethod method = BellmanFordMethod::frontier;
+    unsigned threads = 0;
+};
+
+// Distances and predecessors from one source. dist and parent are final for
+// every vertex the search settled; the rest hold infinity and -1.
+struct ShortestPathResult
+{
+    static constexpr double unreachable = std::numeric_limits<double>::infinity();
+
+    int source = -1;        // -1 when the search started from several vertices
+    std::vector<double> dist;
+    std::vector<int> parent;
+    // Requested targets with no path within the radius, in request order
+    std::vector<int> unreachableTargets;
+    // A negative cycle reachable from the sources, in edge order; when it is
+    // set, dist and parent are not shortest paths
+    std::vector<int> negativeCycle;
+
+    bool reached(int v) const { return dist[v] != unreachable; }
+
+    // Vertices from the source to v, empty when v was not reached or a
+    // negative cycle was found, since the parents then lead into the cycle
+    std::vector<int> path(int v) const
+    {
+        std::vector<int> vertices;
+        if (!reached(v) || !negativeCycle.empty()) {
+            return vertices;
+        }
+        for (; v != -1; v = parent[v]) {
+            vertices.push_back(v);
+        }
+        std::reverse(vertices.begin(), vertices.end());
+        return vertices;
+    }
+
+    // Reached vertex with the largest distance, the end of a critical path; -1 if none
+    int farthest() const
+    {
+        int best = -1;
+        for (int v = 0; v < static_cast<int>(dist.size()); ++v) {
+            if (reached(v) && (best == -1 || dist[v] > dist[best])) {
+                best = v;
+            }
+        }
+        return best;
+    }
+};
+
+// Labels of one Dijkstra search, kept so a thread running many searches
+// allocates once; the per-vertex arrays are placed by the active MemoryPolicy.
+// Between searches every entry is at rest: dist infinite, parent -1, state 0.
+struct DijkstraWorkspace
+{
+    PolicyArray<double> dist;
+    PolicyArray<int> parent;
+    PolicyArray<unsigned char> state;       // 1: settled, 2: target not settled yet
+    std::vector<int> touched;               // vertices whose labels are not at rest
+    std::vector<std::pair<double, int>> heap;
+};
+
+// The Dijkstra kernel behind Graph::shortestPaths(), DijkstraQueries,
+// Johnson's all-pairs rows and DijkstraAsync. Each step() settles one vertex,
+// so callers may stop or yield in between. The search is over once every
+// target is settled, or the heap is empty; vertices farther than
+// options.maxDistance are never settled, and a removed source settles nothing.
+// With 'potential' the weight of u -> v is read as
+// w + potential[u] - potential[v], Johnson's reweighting.
+// Throws std::invalid_argument on a negative weight it reaches.
+class DijkstraSearch
+{
+public:
+    DijkstraSearch(const Graph& graph, DijkstraWorkspace& ws, int source, const std::vector<int>& targets = {},
+                   const ShortestPathOptions& options = {}, const std::vector<double>* potential = nullptr);
+    // Returns the workspace to rest
+    ~DijkstraSearch();
+    DijkstraSearch(const DijkstraSearch&) = delete;
+    DijkstraSearch& operator=(const DijkstraSearch&) = delete;
+
+    // Settles the next vertex; false once the search is over
+    bool step();
+    void run() { while (step()) {} }
+
+    // Out-edges scanned by the last step
+    std::size_t scanned() const { return lastScanned; }
+
+    // distance(v) and the path to v are final once v is settled
+    bool settled(int v) const { return ws.state[v] == 1; }
+    double distance(int v) const { return ws.dist[v]; }
+    std::vector<int> path(int v) const;
+
+    // Vertices whose labels were set, settled or not
+    const std::vector<int>& touched() const { return ws.touched; }
+
+    // Copies the settled labels into a result and leaves the workspace empty
+    ShortestPathResult take();
+
+private:
+    const Graph& graph;
+    DijkstraWorkspace& ws;
+    int source;
+    std::vector<int> targets;
+    std::size_t targetsLeft = 0;
+    double maxDistance;
+    const std::vector<double>* potential;
+    std::size_t lastScanned = 0;
+};
+
+#endif  // SHORTEST_PATHS_H
@@ -1,125 +1,252 @@
 #include "wgraph.h"
+#include "../../common/checkpoint.hpp"
+#include "../../common/graph_kernels.hpp"
+#include "../../common/instrument.hpp"
+#include "../../common/parallel.hpp"
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <limits>
 
-Graph::Graph(int n) 
+Graph::Graph(int n, std::pmr::memory_resource* resource) 
+    : Graph(n, WeightFormat {}, resource)
+{
+}
+
+Graph::Graph(int n, WeightFormat format, std::pmr::memory_resource* resource)
     : numVertices(n) 
-    , adjList(n) 
+    , format(format)
+    , adjList(n, resource) 
+    , edgeVersion(0)
+    , transposed(false)
+    , removed(n, 0)
+    , storedSlots(0)
+    , deadSlots(0)
+    , liveSlotsInto(n, 0)
+    , compactionRatio(0.25)
+    , backgroundCompaction(false)
 {
+    if (format.type == WeightType::uint16Quantized && !(format.scale > 0 && std::isfinite(format.scale))) {
+        throw std::invalid_argument("Invalid weight format!!");
+    }
     adjList.resize(numVertices);
 }
 
+Graph::~Graph()
+{
+    pendingCompaction.wait();
+}
+
 void Graph::addVertex()
 {
+    beginChange();
     ++numVertices;
     adjList.resize(numVertices);
+    removed.push_back(0);
+    liveSlotsInto.push_back(0);
+    ++edgeVersion;
 }
 
 void Graph::addEdge(int u, int v, double weight)
 {
-    adjList[u].push_back({v, weight});
-    adjList[v].push_back({u, weight});
+    if (removed[u] || removed[v]) {
+        throw std::invalid_argument("Vertex is removed!!");
+    }
+    unsigned char encoded[sizeof(double)];
+    format.encode(weight, encoded);
+    beginChange();
+    adjList[u].push(v, encoded, format.bytes());
+    adjList[v].push(u, encoded, format.bytes());
+    storedSlots += 2;
+    ++liveSlotsInto[u];
+    ++liveSlotsInto[v];
+    ++edgeVersion;
 }
 
-void Graph::BFS(int start) const
+void Graph::addDirectedEdge(int u, int v, double weight)
 {
-    std::vector<bool> visit (numVertices, false);
-    std::queue<int> q;
-    visit[start] = true;
-    q.push(start);
-
-    while (!q.empty()) {
-        int tmp = q.front();
-        std::cout << tmp << " ";
-        q.pop();
-        for (auto i : adjList[tmp]) {
-            if (!visit[i.first]) {
-                visit[i.first] = true;
-                q.push(i.first);
-            }
+    if (removed[u] || removed[v]) {
+        throw std::invalid_argument("Vertex is removed!!");
+    }
+    unsigned char encoded[sizeof(double)];
+    format.encode(weight, encoded);
+    beginChange();
+    adjList[u].push(v, encoded, format.bytes());
+    ++storedSlots;
+    ++liveSlotsInto[v];
+    ++edgeVersion;
+}
+
+bool Graph::removeEdge(int u, int v)
+{
+    beginChange();
+    if (!tombstone(u, v)) {
+        return false;
+    }
+    tombstone(v, u);
+    afterRemoval();
+    return true;
+}
+
+bool Graph::removeDirectedEdge(int u, int v)
+{
+    beginChange();
+    if (!tombstone(u, v)) {
+        return false;
+    }
+    afterRemoval();
+    return true;
+}
+
+// O(out-degree of v): the row of v and every edge into it turn into tombstones,
+// and only the row of v is walked to keep the live slot counts
+void Graph::removeVertex(int v)
+{
+    beginChange();
+    if (removed[v]) {
+        return;
+    }
+    removed[v] = 1;
+    // Only live slots die: out-edges to live vertices and every live edge
+    // into v, a self-loop among them
+    for (int x : adjList[v].targets) {
+        if (x >= 0 && x != v && !removed[x]) {
+            ++deadSlots;
+            --liveSlotsInto[x];
         }
     }
-    std::cout << std::endl;
+    deadSlots += liveSlotsInto[v];
+    liveSlotsInto[v] = 0;
+    afterRemoval();
 }
 
-void Graph::DFS_Iterative(int start) const
+bool Graph::isRemoved(int v) const
+{
+    return removed[v] != 0;
+}
+
+void Graph::compact()
+{
+    finishCompaction();
+    installRows(compactedRows());
+}
+
+void Graph::compactInBackground()
+{
+    finishCompaction();
+    pendingCompaction.start([this] { return compactedRows(); });
+}
+
+void Graph::finishCompaction()
 {
-    std::vector<bool> visit(numVertices, false);
-    std::stack<int> st;
+    if (pendingCompaction.running()) {
+        installRows(pendingCompaction.take());
+    }
+}
 
-    visit[start] = true;
-    st.push(start);
+void Graph::setCompactionThreshold(double ratio, bool background)
+{
+    compactionRatio = ratio;
+    backgroundCompaction = background;
+}
 
-    while (!st.empty()) {
-        int tmp = st.top();
-        std::cout << tmp << " ";
-        st.pop();
-        for (auto i : adjList[tmp]) {
-            if (!visit[i.first]) {
-                visit[i.first] = true;
-                st.push(i.first);
+int Graph::size() const
+{
+    return numVertices;
+}
+
+WeightFormat Graph::weightFormat() const
+{
+    return format;
+}
+
+Graph::Neighbors Graph::neighbors(int u) const
+{
+    return out(u);
+}
+
+Graph::Neighbors Graph::inNeighbors(int u) const
+{
+    if (transposed) {
+        return stored(u);
+    }
+    return reverseIndex()->row(u);
+}
+
+// out(u) as a graph for the common/graph_kernels.hpp algorithms
+auto Graph::outGraph() const
+{
+    return neighborGraph(
+        numVertices,
+        [this](int u, auto&& f) {
+            for (int v : out(u).targets()) {
+                f(v, NoWeight {});
             }
-        }
+        },
+        [this](int u) { return removed[u] != 0; });
+}
+
+void Graph::BFS(int start) const
+{
+    GRAPH_SCOPE("Graph::BFS");
+    for (int x : bfsOrder(outGraph(), start)) {
+        std::cout << x << " ";
+    }
+    std::cout << std::endl;
+}
+
+void Graph::DFS_Iterative(int start) const
+{
+    GRAPH_SCOPE("Graph::DFS_Iterative");
+    for (int x : dfsOrder(outGraph(), start)) {
+        std::cout << x << " ";
     }
     std::cout << std::endl;
 }
 
 void Graph::DFS_Recursive(int start) const
 {
-    std::vector<bool> visit(numVertices, false);
-    dfsHelper(start, visit);
+    GRAPH_SCOPE("Graph::DFS_Recursive");
+    for (int x : preorder(outGraph(), start)) {
+        std::cout << x << " ";
+    }
     std::cout << std::endl;
 }
 
 void Graph::print() const
 {
-    for(int i = 0; i < adjList.size(); ++i) {
+    for(int i = 0; i < numVertices; ++i) {
         std::cout << i << " : ";
-        for(auto u : adjList[i]) {
+        for(auto u : out(i)) {
             std::cout << "{" << u.first << ", " << u.second << "}" << " ";
         }
         std::cout << std::endl;
     }
 }
 
+// Flips which side is read as out-edges; the in-edge index is built on the
+// first flip after a change and reused by every later flip
 void Graph::transpose()
 {
-    Graph tmp(numVertices);
-    for(int i = 0; i < numVertices; ++i) {
-        for(auto [u, w] : adjList[i]) {
-            tmp.adjList[u].emplace_back(i, w);
-        }
+    if (transposed) {
+        flipped.reset();
+    } else {
+        flipped = reverseIndex();
     }
-    *this = tmp;
+    transposed = !transposed;
 }
 
-int Graph::ShortestPath(int start, int end) const {
-    std::vector<bool> visit(numVertices, false);
-    std::stack<int> st;
-    for (int i = 0; i < numVertices; ++i) {
-        if (!visit[i]) {
-            dfstopSort(i, visit, st);
-        }
-    }
-    std::vector<int> dist(numVertices, INT_MAX);
-    dist[start] = 0;
-
-    while (!st.empty()) {
-        int tmp = st.top();
-        st.pop();
-
-        if (dist[tmp] != INT_MAX) {
-            for (auto& u : adjList[tmp]) {
-                if (dist[tmp] + u.second < dist[u.first]) {
-                    dist[u.first] = dist[tmp] + u.second;
-                }
-            }
-        }
+double Graph::ShortestPath(int start, int end) const {
+    if (end < 0 || end >= numVertices) {
+        throw std::out_of_range("Invalid vertex!!");
     }
-    int res = dist[end] - dist[start];
-    if (res < 0 || res == INT_MAX) {
-        std::cerr << "Don't way!" << std::endl;
-        exit(0);
+    ShortestPathResult result = dagPaths({start});
+    if (!result.reached(end)) {
+        throw std::runtime_error("No path!!");
     }
-    return res;
+    return result.dist[end];
 }
 
 int Graph::nthLevelNodeCount (int src, int level) const
@@ -127,75 +254,29 @@ int Graph::nthLevelNodeCount (int src, int level) const
     if (level < 0) {
         throw std::invalid_argument("Is the negative number!");
     }
-    std::vector<int> visit (numVertices, false);
-    std::queue<std::pair<int, int>> q;
-    int count = 0;
-    q.push({src, 0});
-    while (!q.empty()) {
-        auto [currNode, currLevel] = q.front();
-        q.pop();
-        if (currLevel == level) {
-            ++count;
-        } else if (currLevel < level) {
-            for(auto u : adjList[currNode]) {
-                if(!visit[u.first]) {
-                    visit[u.first] = true;
-                    q.push({u.first, currLevel + 1});
-                }
-            }
-        }
-    }
-    return count;
+    GRAPH_SCOPE("Graph::nthLevelNodeCount");
+    return static_cast<int>(countAtLevel(outGraph(), src, level));
 }
 
 std::vector<std::vector<int>> Graph::getAllPaths(int src, int dest) const
 {
-    std::vector<bool> visit (numVertices, false);
-    std::vector<std::vector<int>> Paths;
-    std::vector<int> path;
-    dfsAllPathsHelper(src, dest, Paths, path, visit);
-    return Paths;
+    return allSimplePaths(outGraph(), src, dest);
 }
 
 bool Graph::isCycledDirected() const
 {
-    std::vector<bool> visit (numVertices, false);
-    std::vector<bool> recStack (numVertices, false);
-    for (int i = 0; i < numVertices; ++i) {
-        if (!visit[i]) {
-            if (dfsisCycledDirected(i, visit, recStack)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return hasDirectedCycle(outGraph());
 }
 
 bool Graph::isCycledUndirected() const
 {
-    std::vector<bool> visit (numVertices, false);
-    int parent = -1;
-    for (int i = 0; i < numVertices; ++i) {
-        if (!visit[i]) {
-            if (dfsisCycledUndirected(i, visit, parent)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return hasUndirectedCycle(outGraph());
 }
 
 int Graph::DFS_ExtraCase() const
 {
-    std::vector<bool> visit (numVertices, false);
-    int count = 0;
-    for(int i = 0; i < numVertices; ++i) {
-        if (!visit[i]) {
-            dfsExtraCases(i, visit);
-            ++count;
-        }
-    }   
-    return count;
+    std::vector<int> labels = componentLabels(outGraph());
+    return labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
 }
 
 std::vector<int> Graph::topSort() const
@@ -203,20 +284,7 @@ std::vector<int> Graph::topSort() const
     if (isCycledDirected()) {
         throw std::runtime_error("Cycled graph!!");    
     }
-    std::vector<bool> visit (numVertices, false);
-    std::stack<int> st;
-    for (int i = 0; i < numVertices; ++i) {
-        if (!visit[i]) {
-            dfstopSort(i, visit, st);
-        }
-    }
-    std::vector<int> res;
-    while (!st.empty()) {
-        int tmp = st.top();
-        st.pop();
-        res.push_back(tmp);
-    }
-    return res;
+    return finishOrder(outGraph());
 }
 
 std::vector<int> Graph::Kahn() const
@@ -224,227 +292,770 @@ std::vector<int> Graph::Kahn() const
     if (isCycledDirected()) {
         throw std::runtime_error("Cycled graph!!");
     }
-    std::vector<int> indgree (numVertices, 0);
-    for(int i = 0; i < numVertices; ++i) {
-        for (auto u : adjList[i]) {
-            indgree[u.first];
-        }
+    return kahnOrder(outGraph());
+}
+
+std::vector<std::vector<int>> Graph::Kosaraju() const
+{
+    InEdges in = inEdges();
+    return kosarajuComponents(outGraph(), neighborGraph(
+        numVertices,
+        [&in](int u, auto&& f) {
+            for (int v : in[u].targets()) {
+                f(v, NoWeight {});
+            }
+        },
+        [this](int u) { return removed[u] != 0; }));
+}
+
+std::vector<std::vector<int>> Graph::Tarjan() const
+{
+    GRAPH_SCOPE("Graph::Tarjan");
+    return tarjanComponents(outGraph());
+}
+
+////////////////////////////////////////////
+///////////////////////////////////////////
+
+Graph::Neighbors Graph::out(int u) const
+{
+    if (transposed) {
+        return flipped->row(u);
     }
-    std::queue<int> q;
-    for(int i = 0; i < numVertices; ++i) {
-        if (indgree[i] == 0) {
-            q.push(i);
-        }
+    return stored(u);
+}
+
+Graph::Neighbors Graph::stored(int u) const
+{
+    if (removed[u]) {
+        return {};
     }
-    std::vector<int> res;
-    while(!q.empty()) {
-        int tmp = q.front();
-        q.pop();
-        res.push_back(tmp);
-        for(auto u : adjList[tmp]) {
-            --indgree[u.first];
-            if (indgree[u.first] == 0) {
-                q.push(u.first);
-            }
-        }
+    if (frozen) {
+        return frozen->row(u, removed.data());
     }
-    return res;
+    const AdjRow& row = adjList[u];
+    return Neighbors(row.targets.data(), row.targets.data() + row.targets.size(), row.weights.data(), format,
+                     removed.data());
 }
 
-std::vector<std::vector<int>> Graph::Kosaraju()
+Graph::InEdges Graph::inEdges() const
 {
-    std::vector<bool> visit (numVertices, false);
-    std::stack<int> st;
-    for(int i = 0; i < numVertices; ++i) {
-        if (!visit[i]) {
-            fillInOrder(i, visit, st);
+    if (transposed) {
+        return InEdges {this, nullptr};
+    }
+    return InEdges {this, reverseIndex()};
+}
+
+// Built from decoded weights and encoded again, which round-trips exactly
+// because every decoded weight is a value of the format
+std::shared_ptr<const WeightedCsr> Graph::reverseIndex() const
+{
+    return cachedReverse.get(edgeVersion, [this] {
+        Csr<std::pair<int, double>> reverse = reverseCsr<std::pair<int, double>>(
+            numVertices,
+            [this](int u) { return stored(u); },
+            [](int u, const std::pair<int, double>& e) { return std::make_pair(e.first, std::make_pair(u, e.second)); });
+        auto index = std::make_shared<WeightedCsr>();
+        const std::size_t bytes = format.bytes();
+        index->format = format;
+        index->offsets = std::move(reverse.offsets);
+        index->targets.resize(reverse.entries.size());
+        index->weights.resize(reverse.entries.size() * bytes);
+        for (std::size_t k = 0; k < reverse.entries.size(); ++k) {
+            index->targets[k] = reverse.entries[k].first;
+            format.encode(reverse.entries[k].second, index->weights.data() + k * bytes);
         }
-    } 
-    transpose();
-    visit.assign(numVertices, false);
-    std::vector<std::vector<int>> SCC;
-    while (!st.empty()) {
-        int tmp = st.top();
-        st.pop();
-        if (!visit[tmp]) {
-            std::vector<int> component;
-            dfsKosaraju(tmp, visit, component);
-            SCC.push_back(component);
+        return std::shared_ptr<const WeightedCsr>(std::move(index));
+    });
+}
+
+void Graph::assignLive(AdjRow& row, const Neighbors& live) const
+{
+    const std::size_t bytes = format.bytes();
+    row.targets.clear();
+    row.weights.clear();
+    live.forEachEncoded([&](int v, const unsigned char* weight) { row.push(v, weight, bytes); });
+}
+
+void Graph::materialize()
+{
+    if (!transposed) {
+        if (frozen) {
+            for (int u = 0; u < numVertices; ++u) {
+                const std::size_t first = frozen->offsets[u];
+                const std::size_t last = frozen->offsets[u + 1];
+                const std::size_t bytes = format.bytes();
+                adjList[u].targets.assign(frozen->targets.begin() + first, frozen->targets.begin() + last);
+                adjList[u].weights.assign(frozen->weights.begin() + first * bytes, frozen->weights.begin() + last * bytes);
+            }
+            frozen.reset();
+            countSlots();
         }
+        return;
+    }
+    frozen.reset();
+    for (int u = 0; u < numVertices; ++u) {
+        assignLive(adjList[u], flipped->row(u));
     }
-    return SCC;
+    countSlots();
+    flipped.reset();
+    transposed = false;
+    ++edgeVersion;
 }
 
-std::vector<std::vector<int>> Graph::Tarjan() const
+// Settles pending compaction and orientation before the stored rows change
+void Graph::beginChange()
 {
-    std::vector<std::vector<int>> SCC;
-    std::vector<bool> onStack(numVertices, false);
-    std::vector<int> ids(numVertices, -1);
-    std::vector<int> lowlink(numVertices, -1);
-    std::stack<int> st;
+    finishCompaction();
+    materialize();
+}
 
-    for (int i = 0; i < numVertices; ++i) {
-        if (ids[i] == -1) {
-            dfs_tarjan(i, ids, lowlink, st, onStack, SCC);
+bool Graph::tombstone(int u, int v)
+{
+    if (removed[u] || removed[v]) {
+        return false;
+    }
+    for (int& target : adjList[u].targets) {
+        if (target == v) {
+            target = -1;
+            ++deadSlots;
+            --liveSlotsInto[v];
+            return true;
         }
     }
-    return SCC;
+    return false;
 }
 
-////////////////////////////////////////////
-///////////////////////////////////////////
-
-void Graph::dfsHelper(int start, std::vector<bool>& visit) const
+void Graph::afterRemoval()
 {
-    visit[start] = true;
-    std::cout << start << " ";
-    for (auto i : adjList[start]) {
-        if(!visit[i.first]) {
-            dfsHelper(i.first, visit);
+    ++edgeVersion;
+    if (deadSlots > compactionRatio * storedSlots) {
+        if (backgroundCompaction) {
+            compactInBackground();
+        } else {
+            compact();
         }
     }
 }
 
-void Graph::dfstopSort(int src, std::vector<bool>& visit, std::stack<int>& st) const 
+// Reads only, so a background compaction may run beside const queries
+std::pmr::vector<Graph::AdjRow> Graph::compactedRows() const
+{
+    std::pmr::vector<AdjRow> rows(numVertices, adjList.get_allocator());
+    for (int u = 0; u < numVertices; ++u) {
+        assignLive(rows[u], stored(u));
+    }
+    return rows;
+}
+
+void Graph::installRows(std::pmr::vector<AdjRow> rows)
+{
+    adjList.swap(rows);
+    frozen.reset();
+    countSlots();
+}
+
+void Graph::countSlots()
 {
-    visit[src] = true;
-    for (auto& u : adjList[src]) {
-        if (!visit[u.first]) {
-            dfstopSort(u.first, visit, st);
+    storedSlots = 0;
+    deadSlots = 0;
+    liveSlotsInto.assign(numVertices, 0);
+    for (int u = 0; u < numVertices; ++u) {
+        for (int x : adjList[u].targets) {
+            ++storedSlots;
+            if (x < 0 || removed[u] || removed[x]) {
+                ++deadSlots;
+            } else {
+                ++liveSlotsInto[x];
+            }
         }
     }
-    st.push(src);
 }
 
-void Graph::dfsAllPathsHelper(int src, int dest, std::vector<std::vector<int>>& Paths, std::vector<int>& path, std::vector<bool>& visit) const
+void Graph::Dijkstra(int source) {
+    GRAPH_SCOPE("Graph::Dijkstra");
+    ShortestPathResult result = shortestPaths(source);
+    for (int i = 0; i < numVertices; ++i) {
+        std::cout << result.dist[i] << " ";
+    }
+    std::cout << std::endl;
+}
+
+ShortestPathResult Graph::shortestPaths(int source, const std::vector<int>& targets, const ShortestPathOptions& options) const
+{
+    GRAPH_SCOPE("Graph::shortestPaths");
+    DijkstraWorkspace ws;
+    DijkstraSearch search(*this, ws, source, targets, options);
+    search.run();
+    return search.take();
+}
+
+DijkstraSearch::DijkstraSearch(const Graph& graph, DijkstraWorkspace& ws, int source, const std::vector<int>& targets,
+                               const ShortestPathOptions& options, const std::vector<double>* potential)
+    : graph(graph)
+    , ws(ws)
+    , source(source)
+    , maxDistance(options.maxDistance)
+    , potential(potential)
 {
-    visit[src] = true;
-    path.push_back(src);
-    if (src == dest) {
-        Paths.push_back(path);
+    const int n = graph.size();
+    if (source < 0 || source >= n) {
+        throw std::out_of_range("Invalid vertex!!");
+    }
+    for (int t : targets) {
+        if (t < 0 || t >= n) {
+            throw std::out_of_range("Invalid vertex!!");
+        }
     }
-    for(auto u : adjList[src]) {
-        if (!visit[u.first]) {
-            dfsAllPathsHelper(u.first, dest, Paths, path, visit);
+    if (ws.dist.size() != static_cast<std::size_t>(n)) {
+        ws.dist.assign(n, ShortestPathResult::unreachable);
+        ws.parent.assign(n, -1);
+        ws.state.assign(n, 0);
+    }
+    ws.touched.clear();
+    ws.heap.clear();
+
+    this->targets = targets;
+    for (int t : targets) {
+        if (ws.state[t] == 0) {
+            ws.state[t] = 2;
+            ++targetsLeft;
         }
     }
-    visit[src] = false;
-    path.pop_back();
+    if (!graph.isRemoved(source)) {
+        ws.dist[source] = 0;
+        ws.touched.push_back(source);
+        ws.heap.push_back({0, source});
+        GRAPH_HEAP_PUSH();
+    }
 }
 
-bool Graph::dfsisCycledDirected(int src, std::vector<bool>& visit, std::vector<bool>& recStack) const
+DijkstraSearch::~DijkstraSearch()
 {
-    visit[src] = true;
-    recStack[src] = true;
-    for (auto u : adjList[src]) {
-        if (!visit[u.first]) {
-            if (dfsisCycledDirected(u.first, visit, recStack)) {
-                return true;
-            }
-        } else if (recStack[u.first]) {
-            return true;
+    if (!ws.dist.empty()) {
+        for (int v : ws.touched) {
+            ws.dist[v] = ShortestPathResult::unreachable;
+            ws.parent[v] = -1;
+            ws.state[v] = 0;
+        }
+        for (int t : targets) {
+            ws.state[t] = 0;
         }
     }
-    recStack[src] = false;
-    return false;
+    ws.touched.clear();
+    ws.heap.clear();
 }
 
-bool Graph::dfsisCycledUndirected(int src, std::vector<bool>& visit, int parent) const
+bool DijkstraSearch::step()
 {
-    visit[src] = true;
-    for (auto u : adjList[src]) {
-        if (!visit[u.first]) {
-            if (dfsisCycledUndirected(u.first, visit, parent)) {
-                return true;
+    auto later = [](const std::pair<double, int>& a, const std::pair<double, int>& b) { return a.first > b.first; };
+    std::vector<std::pair<double, int>>& heap = ws.heap;
+    double* dist = ws.dist.data();
+    int* parent = ws.parent.data();
+    unsigned char* state = ws.state.data();
+    lastScanned = 0;
+    while (!heap.empty() && (targets.empty() || targetsLeft > 0)) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        auto [d, u] = heap.back();
+        heap.pop_back();
+
+        // Skip entries superseded by a later, shorter push
+        if (d > dist[u] || state[u] == 1) {
+            GRAPH_STALE_POP();
+            continue;
+        }
+        GRAPH_VISIT();
+        targetsLeft -= state[u] == 2;
+        state[u] = 1;
+
+        // Instantiated per weight reading, so plain searches pay nothing for potentials
+        std::size_t edges = 0;
+        auto scan = [&](auto reweight) {
+            for (const auto& [v, weight] : graph.neighbors(u)) {
+                GRAPH_EDGE();
+                ++edges;
+                const double w = reweight(weight, v);
+                if (w < 0) {
+                    throw std::invalid_argument("Negative edge weight!!");
+                }
+                const double nd = d + w;
+                if (nd < dist[v] && nd <= maxDistance) {
+                    if (dist[v] == ShortestPathResult::unreachable) {
+                        ws.touched.push_back(v);
+                    }
+                    dist[v] = nd;
+                    parent[v] = u;
+                    heap.push_back({nd, v});
+                    std::push_heap(heap.begin(), heap.end(), later);
+                    GRAPH_HEAP_PUSH();
+                }
             }
-        } else if (u.first != parent) {
-            return true;
+        };
+        if (potential) {
+            const double* h = potential->data();
+            scan([h, hu = h[u]](double weight, int v) { return weight + hu - h[v]; });
+        } else {
+            scan([](double weight, int) { return weight; });
         }
+        lastScanned = edges;
+        return true;
     }
     return false;
 }
 
-void Graph::dfsKosaraju(int src, std::vector<bool>& visit, std::vector<int>& component) const
+std::vector<int> DijkstraSearch::path(int v) const
+{
+    std::vector<int> vertices;
+    if (!settled(v)) {
+        return vertices;
+    }
+    for (; v != -1; v = ws.parent[v]) {
+        vertices.push_back(v);
+    }
+    std::reverse(vertices.begin(), vertices.end());
+    return vertices;
+}
+
+ShortestPathResult DijkstraSearch::take()
+{
+    ShortestPathResult result;
+    result.source = source;
+    // Labels of vertices left in the heap are only upper bounds
+    for (int v : ws.touched) {
+        if (ws.state[v] != 1) {
+            ws.dist[v] = ShortestPathResult::unreachable;
+            ws.parent[v] = -1;
+        }
+    }
+    for (int t : targets) {
+        if (ws.state[t] != 1) {
+            result.unreachableTargets.push_back(t);
+        }
+    }
+    result.dist.assign(ws.dist.begin(), ws.dist.end());
+    result.parent.assign(ws.parent.begin(), ws.parent.end());
+    ws.dist.clear();
+    ws.parent.clear();
+    ws.state.clear();
+    ws.touched.clear();
+    return result;
+}
+
+// Kahn's algorithm one level at a time: a vertex joins the next level when
+// its last in-edge is consumed, so all of its in-neighbours are final and
+// its distance can be pulled from them without synchronization.
+ShortestPathResult Graph::dagPaths(const std::vector<int>& sources, const DagPathOptions& options) const
 {
-    visit[src] = true;
-    component.push_back(src);
-    for (auto& u : adjList[src]) {
-        if (!visit[u.first]) {
-            dfsKosaraju(u.first, visit, component);
+    GRAPH_SCOPE("Graph::dagPaths");
+    const std::size_t grain = 1 << 10;
+    std::vector<unsigned char> isSource(numVertices, 0);
+    for (int s : sources) {
+        if (s < 0 || s >= numVertices) {
+            throw std::out_of_range("Invalid vertex!!");
+        }
+        isSource[s] = 1;
+    }
+
+    InEdges in = inEdges();
+    std::vector<std::atomic<int>> pending(numVertices);
+    parallelFor(0, numVertices, [&](std::size_t v) {
+        NeighborRange<int> row = in[v].targets();
+        pending[v].store(removed[v] ? -1 : static_cast<int>(std::distance(row.begin(), row.end())),
+                         std::memory_order_relaxed);
+    }, options.threads, grain);
+
+    std::vector<int> level;
+    for (int v = 0; v < numVertices; ++v) {
+        if (pending[v].load(std::memory_order_relaxed) == 0) {
+            level.push_back(v);
+        }
+    }
+
+    ShortestPathResult result;
+    result.source = sources.size() == 1 ? sources.front() : -1;
+    result.dist.assign(numVertices, ShortestPathResult::unreachable);
+    result.parent.assign(numVertices, -1);
+    const bool longest = options.longest;
+    const bool fromRoots = sources.empty();
+    std::size_t ordered = 0;
+    std::vector<std::vector<int>> next;
+
+    while (!level.empty()) {
+        GRAPH_FRONTIER(level.size());
+        ordered += level.size();
+        const unsigned workers = workerCount(level.size(), options.threads, grain);
+        next.resize(workers);
+        parallelForWorker(0, level.size(), [&](unsigned worker, std::size_t k) {
+            const int v = level[k];
+            GRAPH_VISIT();
+            double best = fromRoots ? (in[v].empty() ? 0 : ShortestPathResult::unreachable)
+                                    : (isSource[v] ? 0 : ShortestPathResult::unreachable);
+            int from = -1;
+            for (const auto& [u, w] : in[v]) {
+                GRAPH_EDGE();
+                if (result.dist[u] == ShortestPathResult::unreachable) {
+                    continue;
+                }
+                double d = result.dist[u] + w;
+                if (best == ShortestPathResult::unreachable || (longest ? d > best : d < best)) {
+                    best = d;
+                    from = u;
+                }
+            }
+            result.dist[v] = best;
+            result.parent[v] = from;
+            for (int t : out(v).targets()) {
+                if (pending[t].fetch_sub(1, std::memory_order_relaxed) == 1) {
+                    next[worker].push_back(t);
+                }
+            }
+        }, workers, grain);
+        level.clear();
+        for (std::vector<int>& part : next) {
+            level.insert(level.end(), part.begin(), part.end());
+            part.clear();
         }
     }
+
+    std::size_t live = 0;
+    for (int v = 0; v < numVertices; ++v) {
+        live += !removed[v];
+    }
+    if (ordered != live) {
+        throw std::runtime_error("Cycled graph!!");
+    }
+    return result;
 }
 
-void Graph::dfsExtraCases(int src, std::vector<bool>& visit) const
+namespace {
+
+// A cycle of the predecessor graph in edge order, or empty if it is a forest.
+// Every such cycle has negative weight, both under one-at-a-time relaxation
+// and under the pull rounds below, and one appears eventually whenever a
+// negative cycle is reachable. Checking after every 4n scanned edges keeps
+// the O(n) search to amortized O(1) per edge.
+std::vector<int> parentCycle(const std::vector<int>& parent)
 {
-    visit[src] = true;
-    for(auto u : adjList[src]) {
-        if (!visit[u.first]) {
-            dfsExtraCases(u.first, visit);
+    const int n = static_cast<int>(parent.size());
+    std::vector<int> walk(n, -1);
+    for (int start = 0; start < n; ++start) {
+        int v = start;
+        while (v != -1 && walk[v] == -1) {
+            walk[v] = start;
+            v = parent[v];
+        }
+        if (v != -1 && walk[v] == start) {
+            std::vector<int> cycle {v};
+            for (int u = parent[v]; u != v; u = parent[u]) {
+                cycle.push_back(u);
+            }
+            std::reverse(cycle.begin(), cycle.end());
+            return cycle;
         }
     }
+    return {};
 }
 
-void Graph::fillInOrder(int src, std::vector<bool>& visit, std::stack<int>& st) const
+}
+
+ShortestPathResult Graph::bellmanFord(const std::vector<int>& sources, const BellmanFordOptions& options) const
 {
-    dfstopSort(src, visit, st);
+    GRAPH_SCOPE("Graph::bellmanFord");
+    ShortestPathResult result;
+    result.source = sources.size() == 1 ? sources.front() : -1;
+    result.dist.assign(numVertices, ShortestPathResult::unreachable);
+    result.parent.assign(numVertices, -1);
+    std::vector<int> starts;
+    for (int s : sources) {
+        if (s < 0 || s >= numVertices) {
+            throw std::out_of_range("Invalid vertex!!");
+        }
+        if (!removed[s] && result.dist[s] != 0) {
+            result.dist[s] = 0;
+            starts.push_back(s);
+        }
+    }
+    if (sources.empty()) {
+        for (int v = 0; v < numVertices; ++v) {
+            if (!removed[v]) {
+                result.dist[v] = 0;
+                starts.push_back(v);
+            }
+        }
+    }
+    if (options.method == BellmanFordMethod::spfa) {
+        spfa(result, starts);
+    } else {
+        frontierBellmanFord(result, std::move(starts), options.threads);
+    }
+    return result;
 }
 
-void Graph::dfs_tarjan(int src, std::vector<int>& ids, std::vector<int>& lowlink, std::stack<int>& st, std::vector<bool>& onStack, std::vector<std::vector<int>>& SCC) const
+// Each round pulls every candidate, an out-neighbour of last round's
+// frontier, from its in-edges. Reads see only the distances of the previous
+// round and each candidate is written by one worker, so rounds need no
+// locks and give the same result for any thread count.
+void Graph::frontierBellmanFord(ShortestPathResult& result, std::vector<int> frontier, unsigned threads) const
 {
-    static int visitingTime = 0;
-    ids[src] = lowlink[src] = ++visitingTime;
-    st.push(src);
-    onStack[src] = true;
+    const std::size_t grain = 1 << 10;
+    InEdges in = inEdges();
+    std::vector<double>& dist = result.dist;
+    std::vector<double> pulled(numVertices);
+    std::vector<std::atomic<unsigned char>> candidate(numVertices);
+    std::vector<unsigned char> improved(numVertices, 0);
+    std::vector<std::vector<int>> found;
+    std::vector<int> candidates;
+    std::atomic<std::size_t> scanned {0};
+
+    while (!frontier.empty()) {
+        GRAPH_FRONTIER(frontier.size());
+        unsigned workers = workerCount(frontier.size(), threads, grain);
+        found.assign(workers, {});
+        parallelForWorker(0, frontier.size(), [&](unsigned worker, std::size_t k) {
+            for (int t : out(frontier[k]).targets()) {
+                if (candidate[t].exchange(1, std::memory_order_relaxed) == 0) {
+                    found[worker].push_back(t);
+                }
+            }
+        }, workers, grain);
+        candidates.clear();
+        for (const std::vector<int>& part : found) {
+            candidates.insert(candidates.end(), part.begin(), part.end());
+        }
+
+        parallelFor(0, candidates.size(), [&](std::size_t k) {
+            const int v = candidates[k];
+            GRAPH_VISIT();
+            double best = dist[v];
+            int from = -1;
+            Neighbors row = in[v];
+            scanned.fetch_add(row.size(), std::memory_order_relaxed);
+            for (const auto& [u, w] : row) {
+                GRAPH_EDGE();
+                if (dist[u] != ShortestPathResult::unreachable && dist[u] + w < best) {
+                    best = dist[u] + w;
+                    from = u;
+                }
+            }
+            pulled[v] = best;
+            if (from != -1) {
+                result.parent[v] = from;
+                improved[v] = 1;
+            }
+        }, threads, grain);
 
-    for (auto v : adjList[src]) {
-        if (ids[v.first] == -1) {
-            dfs_tarjan(v.first, ids, lowlink, st, onStack, SCC);
+        frontier.clear();
+        for (int v : candidates) {
+            candidate[v].store(0, std::memory_order_relaxed);
+            if (improved[v]) {
+                improved[v] = 0;
+                dist[v] = pulled[v];
+                frontier.push_back(v);
+            }
         }
-        if (onStack[v.first]) {
-            lowlink[src] = std::min(lowlink[src], lowlink[v.first]);
+        if (!frontier.empty() && scanned.load(std::memory_order_relaxed) >= 4 * static_cast<std::size_t>(numVertices)) {
+            scanned.store(0, std::memory_order_relaxed);
+            result.negativeCycle = parentCycle(result.parent);
+            if (!result.negativeCycle.empty()) {
+                return;
+            }
         }
     }
+}
+
+// Small Label First puts a vertex at the front when it is below the front's
+// label; Large Label Last rotates the front to the back while it is above
+// the queue's mean label, at most once around the queue per pop. The sum of
+// queued labels is compensated (Neumaier), so adding and removing labels of
+// very different magnitude does not leave it drifting.
+void Graph::spfa(ShortestPathResult& result, const std::vector<int>& starts) const
+{
+    std::vector<double>& dist = result.dist;
+    std::vector<unsigned char> queued(numVertices, 0);
+    std::deque<int> queue(starts.begin(), starts.end());
+    std::size_t scanned = 0;
+    double sum = 0;
+    double compensation = 0;
+    auto accumulate = [&](double x) {
+        double t = sum + x;
+        compensation += std::fabs(sum) >= std::fabs(x) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    };
+    for (int s : starts) {
+        queued[s] = 1;
+    }
 
-    if (lowlink[src] == ids[src]) {
-        std::vector<int> currSCC;
-        while (st.top() != src) {
-            int elem = st.top();
-            currSCC.push_back(elem);
-            st.pop();
-            onStack[elem] = false;
+    while (!queue.empty()) {
+        const double mean = (sum + compensation) / static_cast<double>(queue.size());
+        for (std::size_t turns = queue.size(); turns > 1 && dist[queue.front()] > mean; --turns) {
+            queue.push_back(queue.front());
+            queue.pop_front();
         }
+        int u = queue.front();
+        queue.pop_front();
+        queued[u] = 0;
+        accumulate(-dist[u]);
+        GRAPH_VISIT();
 
-        currSCC.push_back(st.top());
-        onStack[st.top()] = false;
-        st.pop();
-        SCC.push_back(currSCC);
+        if (++scanned >= 4 * static_cast<std::size_t>(numVertices)) {
+            scanned = 0;
+            result.negativeCycle = parentCycle(result.parent);
+            if (!result.negativeCycle.empty()) {
+                return;
+            }
+        }
+        for (const auto& [v, w] : out(u)) {
+            GRAPH_EDGE();
+            ++scanned;
+            double d = dist[u] + w;
+            if (d >= dist[v]) {
+                continue;
+            }
+            if (queued[v]) {
+                accumulate(-dist[v]);
+            }
+            dist[v] = d;
+            result.parent[v] = u;
+            accumulate(d);
+            if (!queued[v]) {
+                queued[v] = 1;
+                if (!queue.empty() && d < dist[queue.front()]) {
+                    queue.push_front(v);
+                } else {
+                    queue.push_back(v);
+                }
+            }
+        }
     }
 }
 
-void Graph::Dijkstra(int source) {
-    std::vector<int> dist(numVertices, std::numeric_limits<int>::max());
-    std::priority_queue<std::pair<int, int>> pq;
+PageRankResult Graph::pageRank(const PageRankOptions& options) const
+{
+    GRAPH_SCOPE("Graph::pageRank");
+    return pullPageRank(numVertices, inEdges(), uniformTeleport(removed), options);
+}
+
+PageRankResult Graph::personalizedPageRank(const std::vector<int>& seeds, const PageRankOptions& options) const
+{
+    GRAPH_SCOPE("Graph::personalizedPageRank");
+    return pullPageRank(numVertices, inEdges(), seedTeleport(removed, seeds), options);
+}
 
-    dist[source] = 0;
-    pq.push({0, source});
+namespace {
 
-    while (!pq.empty()) {
-        int u = pq.top().second;
-        pq.pop();
+// Offsets and targets are checked by getCsr(); the weights must match them in length
+WeightedCsr getWeightedCsr(CheckpointReader& reader, int n, WeightFormat format)
+{
+    Csr<int> csr = getCsr<int>(reader, n);
+    WeightedCsr rows;
+    rows.format = format;
+    rows.offsets = std::move(csr.offsets);
+    rows.targets = std::move(csr.entries);
+    reader.getVector(rows.weights);
+    if (rows.weights.size() != rows.targets.size() * format.bytes()) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    return rows;
+}
 
-        for (auto v : adjList[u]) {
-            int weight = v.second;
+}
 
-            if (dist[u] + weight < dist[v.first]) {
-                dist[v.first] = dist[u] + weight;
-                pq.push({dist[v.first], v.first});
+// Rows are written compacted, so tombstones are not carried over
+void Graph::save(std::ostream& os) const
+{
+    GRAPH_SCOPE("Graph::save");
+    CheckpointWriter writer(os, checkpoint_detail::weightedGraph);
+    writer.put(numVertices);
+    writer.put(edgeVersion);
+    writer.put(static_cast<unsigned char>(transposed));
+    writer.put(compactionRatio);
+    writer.put(static_cast<unsigned char>(backgroundCompaction));
+    writer.put(static_cast<unsigned char>(format.type));
+    writer.put(format.scale);
+    writer.putVector(removed);
+    putRows<int>(writer, numVertices, [this](int u) { return stored(u).targets(); });
+    std::size_t live = 0;
+    for (int u = 0; u < numVertices; ++u) {
+        NeighborRange<int> row = stored(u).targets();
+        live += static_cast<std::size_t>(std::distance(row.begin(), row.end()));
+    }
+    writer.beginVector(live * format.bytes());
+    std::vector<unsigned char> staging;
+    staging.reserve(1 << 16);
+    for (int u = 0; u < numVertices; ++u) {
+        stored(u).forEachEncoded([&](int, const unsigned char* weight) {
+            staging.insert(staging.end(), weight, weight + format.bytes());
+            if (staging.size() + sizeof(double) > staging.capacity()) {
+                writer.putElements(staging.data(), staging.size());
+                staging.clear();
             }
-        }
+        });
+    }
+    writer.putElements(staging.data(), staging.size());
+    std::shared_ptr<const WeightedCsr> index = flipped;
+    if (!index) {
+        cachedReverse.peek(edgeVersion, index);
     }
+    writer.put(static_cast<unsigned char>(index != nullptr));
+    if (index) {
+        writer.putVector(index->offsets);
+        writer.putVector(index->targets);
+        writer.putVector(index->weights);
+    }
+    writer.finish();
+}
 
-    for (int i = 0; i < numVertices; ++i) {
-        std::cout << dist[i] << " ";
+// Reads and checks everything first; the loaded rows stay frozen until the next change
+void Graph::restore(std::istream& is)
+{
+    GRAPH_SCOPE("Graph::restore");
+    CheckpointReader reader(is, checkpoint_detail::weightedGraph);
+    const int n = reader.get<int>();
+    if (n < 0) {
+        throw std::runtime_error("Corrupt checkpoint!!");
     }
-    std::cout << std::endl;
-}
\ No newline at end of file
+    const std::uint64_t edges = reader.get<std::uint64_t>();
+    const bool isTransposed = reader.get<unsigned char>() != 0;
+    const double ratio = reader.get<double>();
+    const bool background = reader.get<unsigned char>() != 0;
+    WeightFormat weights;
+    const unsigned char type = reader.get<unsigned char>();
+    weights.type = static_cast<WeightType>(type);
+    weights.scale = reader.get<double>();
+    if (type > static_cast<unsigned char>(WeightType::int32) || !(weights.scale > 0 && std::isfinite(weights.scale))) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    std::vector<unsigned char> removedFlags;
+    reader.getVector(removedFlags);
+    if (removedFlags.size() != static_cast<std::size_t>(n)) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    auto rows = std::make_shared<const WeightedCsr>(getWeightedCsr(reader, n, weights));
+    std::shared_ptr<const WeightedCsr> index;
+    if (reader.get<unsigned char>()) {
+        index = std::make_shared<const WeightedCsr>(getWeightedCsr(reader, n, weights));
+    }
+    if (isTransposed && !index) {
+        throw std::runtime_error("Corrupt checkpoint!!");
+    }
+    reader.finish();
+
+    finishCompaction();
+    std::pmr::vector<AdjRow> empty(n, adjList.get_allocator());
+    adjList.swap(empty);
+    numVertices = n;
+    format = weights;
+    frozen = std::move(rows);
+    removed = std::move(removedFlags);
+    storedSlots = frozen->targets.size();
+    deadSlots = 0;
+    edgeVersion = edges;
+    compactionRatio = ratio;
+    backgroundCompaction = background;
+    transposed = isTransposed;
+    flipped = isTransposed ? index : nullptr;
+    cachedReverse.clear();
+    if (index) {
+        cachedReverse.put(edgeVersion, index);
+    }
+}
@@ -7,19 +7,63 @@
 #include <stack>
 #include <queue>
 #include <map>  
+#include <memory>
+#include <memory_resource>
+#include "../../common/csr.hpp"
+#include "../../common/pagerank.hpp"
+#include "../../common/pending_result.hpp"
+#include "../../common/versioned_value.hpp"
+#include "edge_weights.h"
+#include "shortest_paths.h"
 
 class Graph
 {
 public:
-    Graph(int n);
+    // Targets and weights of a row live in separate arrays; Neighbors yields
+    // {target, weight} pairs and Neighbors::targets() the targets alone
+    using AdjRow = WeightedRow;
+    using Neighbors = WeightedNeighbors;
+
+    Graph(int n, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // Weights are stored as 'format' selects; addEdge() throws std::invalid_argument
+    // for a weight it cannot hold instead of truncating it
+    Graph(int n, WeightFormat format, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // Copies and moves wait for a background compaction of the source first
+    Graph(const Graph&) = default;
+    Graph(Graph&&) = default;
+    Graph& operator=(const Graph&) = default;
+    Graph& operator=(Graph&&) = default;
+    ~Graph();
     void addVertex();
     void addEdge(int src, int dest, double weight);  
+    void addDirectedEdge(int src, int dest, double weight);
+    // Removal marks tombstones and keeps vertex ids stable; false when no such edge.
+    // Edge removal scans the rows of its ends for the slot, O(deg); removeVertex()
+    // walks only the row of v, O(out-degree of v)
+    bool removeEdge(int src, int dest);
+    bool removeDirectedEdge(int src, int dest);
+    void removeVertex(int v);
+    bool isRemoved(int v) const;
+    // Drops tombstones; compactInBackground() lets const queries run meanwhile
+    // and the next change, or finishCompaction(), installs the result
+    void compact();
+    void compactInBackground();
+    void finishCompaction();
+    // Compacts once tombstones exceed 'ratio' of the stored edge slots
+    void setCompactionThreshold(double ratio, bool background = false);
+    int size() const;
+    WeightFormat weightFormat() const;
+    Neighbors neighbors(int u) const;
+    // {source, weight} of every edge into u, from the lazily built in-edge index
+    Neighbors inNeighbors(int u) const;
     void BFS(int start) const;
     void DFS_Iterative(int start) const;
     void DFS_Recursive(int start) const;
     void print() const;
     void transpose();
-    int ShortestPath(int start, int end) const;
+    // Shortest path length in a DAG; throws std::runtime_error on a cycle or
+    // when 'end' cannot be reached
+    double ShortestPath(int start, int end) const;
     int nthLevelNodeCount (int src, int level) const;
     std::vector<std::vector<int>> getAllPaths(int src, int dest) const;
     bool isCycledDirected() const;
@@ -27,25 +71,85 @@ public:
     int DFS_ExtraCase() const;
     std::vector<int> topSort() const;
     std::vector<int> Kahn() const;
-    std::vector<std::vector<int>> Kosaraju();
+    std::vector<std::vector<int>> Kosaraju() const;
     std::vector<std::vector<int>> Tarjan() const;
     void Dijkstra(int source);
+    // Dijkstra from 'source' that stops once every vertex of 'targets' is settled,
+    // or settles all vertices within options.maxDistance when 'targets' is empty.
+    // A removed source reaches nothing. Throws std::invalid_argument on a
+    // negative weight it reaches.
+    ShortestPathResult shortestPaths(int source, const std::vector<int>& targets = {},
+                                     const ShortestPathOptions& options = {}) const;
+    // Shortest or longest paths in a DAG from 'sources', or from every vertex
+    // without in-edges when 'sources' is empty. Vertices are relaxed one
+    // topological level at a time, each level in parallel, so any weights are
+    // fine. Throws std::runtime_error("Cycled graph!!") on a cycle.
+    ShortestPathResult dagPaths(const std::vector<int>& sources = {}, const DagPathOptions& options = {}) const;
+    // Shortest paths with negative weights from 'sources', or from every vertex
+    // when 'sources' is empty. Reports a reachable negative cycle in the result.
+    ShortestPathResult bellmanFord(const std::vector<int>& sources, const BellmanFordOptions& options = {}) const;
+    // Ranks follow the edge structure only; weights are ignored
+    PageRankResult pageRank(const PageRankOptions& options = {}) const;
+    PageRankResult personalizedPageRank(const std::vector<int>& seeds, const PageRankOptions& options = {}) const;
+    // Checksummed binary snapshot of the graph and its in-edge index; restore()
+    // throws std::runtime_error on a corrupt snapshot and leaves the graph as it was
+    void save(std::ostream& os) const;
+    void restore(std::istream& is);
 
 private:
-    void dfsHelper(int start, std::vector<bool>& visit) const;
-    void dfstopSort(int src, std::vector<bool>& visit, std::stack<int>& st) const; 
-    void dfsAllPathsHelper(int src, int dest, std::vector<std::vector<int>>& Paths, std::vector<int>& path, std::vector<bool>& visit) const;
-    bool dfsisCycledDirected(int src, std::vector<bool>& visit, std::vector<bool>& recstack) const;
-    bool dfsisCycledUndirected(int src, std::vector<bool>& visit, int parent) const;
-    void dfsKosaraju(int src, std::vector<bool>& visit, std::vector<int>& component) const;
-    void dfsExtraCases(int src, std::vector<bool>& visit) const;
-    void fillInOrder(int src, std::vector<bool>& visit, std::stack<int>& st) const;
-    // Graph scc_transpose() const;
-    void dfs_tarjan(int src, std::vector<int>& ids, std::vector<int>& lowlink, std::stack<int>& st, std::vector<bool>& onStack, std::vector<std::vector<int>>& SCC) const;
+    // In-edges of the current orientation, pinned for one algorithm run;
+    // 'index' is null when the stored rows already are the in-edges
+    struct InEdges
+    {
+        const Graph* graph = nullptr;
+        std::shared_ptr<const WeightedCsr> index;
+
+        Neighbors operator[](int u) const { return index ? index->row(u) : graph->stored(u); }
+    };
+
+    Neighbors out(int u) const;
+    Neighbors stored(int u) const;
+    // out(u) as a graph for the common/graph_kernels.hpp algorithms; defined in wgraph.cpp
+    auto outGraph() const;
+    InEdges inEdges() const;
+    std::shared_ptr<const WeightedCsr> reverseIndex() const;
+    // Replaces 'row' with the live edges of 'live', copying weights still encoded
+    void assignLive(AdjRow& row, const Neighbors& live) const;
+    void materialize();
+    void beginChange();
+    bool tombstone(int u, int v);
+    void afterRemoval();
+    std::pmr::vector<AdjRow> compactedRows() const;
+    void installRows(std::pmr::vector<AdjRow> rows);
+    // Recounts the stored, dead and live incoming slots of adjList
+    void countSlots();
+    void spfa(ShortestPathResult& result, const std::vector<int>& starts) const;
+    void frontierBellmanFord(ShortestPathResult& result, std::vector<int> frontier, unsigned threads) const;
 
 private:
+    // Declared first so copies, moves and assignments wait for it before touching the rows
+    PendingResult<std::pmr::vector<AdjRow>> pendingCompaction;
     int numVertices;
-    std::vector<std::vector<std::pair<int, int>>> adjList;
+    WeightFormat format;
+    std::pmr::vector<AdjRow> adjList;
+    // Rows loaded by restore(), read in place until the first change copies them into adjList
+    std::shared_ptr<const WeightedCsr> frozen;
+
+    // While transposed, out-edges are read from 'flipped', the in-edge index
+    // of the stored rows; edgeVersion changes only with the stored rows
+    std::uint64_t edgeVersion;
+    bool transposed;
+    std::shared_ptr<const WeightedCsr> flipped;
+    VersionedValue<std::shared_ptr<const WeightedCsr>> cachedReverse;
+
+    // Tombstones: a removed vertex is flagged here, a removed edge slot has target -1
+    std::vector<unsigned char> removed;
+    std::size_t storedSlots;
+    std::size_t deadSlots;
+    // Live stored slots pointing at each vertex, valid while adjList holds the rows
+    std::vector<int> liveSlotsInto;
+    double compactionRatio;
+    bool backgroundCompaction;
 };
 
 #endif  // GRAPH_H
@@ -0,0 +1,41 @@
+#include "wgraph_async.h"
+#include "wgraph.h"
+#include "../../common/graph_kernels_async.hpp"
+
+namespace {
+
+std::uint64_t edgeCount(const Graph& graph)
+{
+    std::uint64_t m = 0;
+    for (int u = 0; u < graph.size(); ++u) {
+        m += graph.neighbors(u).size();
+    }
+    return m;
+}
+
+} // namespace
+
+Task<std::vector<double>> DijkstraAsync(const Graph& graph, int source, AsyncContext ctx)
+{
+    ctx.progress->total = edgeCount(graph);
+    DijkstraWorkspace ws;
+    DijkstraSearch search(graph, ws, source);
+    while (search.step()) {
+        if (ctx.tick(search.scanned() + 1)) {
+            co_await ctx.yield();
+        }
+    }
+    ctx.finish();
+    co_return search.take().dist;
+}
+
+Task<std::vector<std::vector<int>>> getAllPathsAsync(const Graph& graph, int src, int dest, AsyncContext ctx)
+{
+    return allSimplePathsAsync(graph, [&graph](int u) { return graph.neighbors(u).targets(); }, src, dest,
+                               std::move(ctx));
+}
+
+Task<std::vector<std::vector<int>>> KosarajuAsync(const Graph& graph, AsyncContext ctx)
+{
+    return kosarajuAsync(graph, [&graph](int u) { return graph.neighbors(u).targets(); }, std::move(ctx));
+}
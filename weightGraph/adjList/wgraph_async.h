@@ -0,0 +1,24 @@
+#ifndef WGRAPH_ASYNC_H
+#define WGRAPH_ASYNC_H
+
+// Coroutine versions of the long-running Graph algorithms. Requires C++20.
+// Each one yields to its executor every ctx.yieldEvery edges, reports
+// progress through ctx.progress and stops with OperationCancelled once
+// ctx.stop is requested. The graph must not change while a task runs.
+
+#include <vector>
+#include "../../common/async.hpp"
+
+class Graph;
+
+// Dijkstra's distances from 'source'; unreachable vertices, or all of them
+// when 'source' is removed, get infinity
+Task<std::vector<double>> DijkstraAsync(const Graph& graph, int source, AsyncContext ctx);
+
+// Every simple path from 'src' to 'dest'
+Task<std::vector<std::vector<int>>> getAllPathsAsync(const Graph& graph, int src, int dest, AsyncContext ctx);
+
+// Kosaraju's strongly connected components; the graph itself is not transposed
+Task<std::vector<std::vector<int>>> KosarajuAsync(const Graph& graph, AsyncContext ctx);
+
+#endif  // WGRAPH_ASYNC_H